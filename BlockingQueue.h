@@ -1,10 +1,19 @@
 ﻿#pragma once
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable> 
-#include <deque>              
+#include <cstddef>
+#include <cstdint>
 #include <exception>          
+#include <memory>
 #include <mutex>              
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 namespace core {
 
@@ -17,17 +26,100 @@ public:
     }
 };
 
+/**
+ * @class RingStorage
+ * @brief BlockingQueue 使用的环形存储：元素原地构造在一块连续内存中。
+ *
+ * 与 std::deque 不同，出队不会释放内存，入队只在容量不足时按倍数扩容，
+ * 因此在容量稳定之后入队、出队都不再分配内存。本身不是线程安全的。
+ */
+template <typename T>
+class RingStorage
+{
+public:
+    RingStorage() = default;
+
+    ~RingStorage()
+    {
+        clear();
+        std::allocator<T>().deallocate(slots, slotCount);
+    }
+
+    RingStorage(const RingStorage&) = delete;
+    RingStorage& operator=(const RingStorage&) = delete;
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void reserve(size_t newCapacity)
+    {
+        if (newCapacity <= slotCount) {
+            return;
+        }
+        T* newSlots = std::allocator<T>().allocate(newCapacity);
+        for (size_t i = 0; i < count; ++i) {
+            T& old = slots[(head + i) % slotCount];
+            std::construct_at(newSlots + i, std::move(old));
+            std::destroy_at(&old);
+        }
+        std::allocator<T>().deallocate(slots, slotCount);
+        slots = newSlots;
+        slotCount = newCapacity;
+        head = 0;
+    }
+
+    template <typename U>
+    void push_back(U&& item)
+    {
+        if (count == slotCount) {
+            reserve(slotCount == 0 ? 16 : slotCount * 2);
+        }
+        size_t tail = head + count;
+        if (tail >= slotCount) {
+            tail -= slotCount;
+        }
+        std::construct_at(slots + tail, std::forward<U>(item));
+        ++count;
+    }
+
+    T& front() { return slots[head]; }
+
+    void pop_front()
+    {
+        std::destroy_at(slots + head);
+        if (++head == slotCount) {
+            head = 0;
+        }
+        --count;
+    }
+
+    void clear()
+    {
+        while (count != 0) {
+            pop_front();
+        }
+    }
+
+private:
+    T* slots = nullptr;
+    size_t slotCount = 0;
+    size_t head = 0;
+    size_t count = 0;
+};
+
 /**
  * @class BlockingQueue
- * @brief 一个为“单生产者、单消费者”(SPSC)场景优化的线程安全阻塞队列。
+ * @brief 基于互斥锁的线程安全阻塞队列，可选容量上限。
  *
  * @tparam T 队列中存储的元素类型。
  *
- * 该队列保证了在一个生产者线程和一个消费者线程之间进行数据交换时的线程安全。
- * 它不适用于多生产者或多消费者的场景。
+ * 所有操作都在同一把锁下进行，多个生产者和消费者同时使用也是安全的；
+ * 需要有界、无锁的多生产者多消费者队列时请使用 MpmcBlockingQueue。
  * - 生产者通过 `push` 向队列尾部添加元素。
  * - 消费者通过 `pop` 从队列头部取出元素。
  * - 如果队列为空，`pop` 操作会阻塞消费者线程，直到有新元素被推入或队列被关闭。
+ * - 指定了容量时，队列满后 `push` 会阻塞生产者，慢消费者不会让内存无限增长；
+ *   `try_push` / `push_for` 提供不阻塞或限时的版本。
  *
  * <h2>使用示例</h2>
  * @code
@@ -56,34 +148,73 @@ template <typename T>
 class BlockingQueue
 {
 private:
-    std::deque<T> queue;            
-    std::condition_variable cv;     
+    RingStorage<T> queue;
+    std::condition_variable cv;         // 队列非空或已关闭
+    std::condition_variable notFull;    // 有界队列有空位或已关闭
     mutable std::mutex mutex;       
     bool closed = false;            
+    size_t capacity = 0;                // 0 表示无界
+    size_t highWater = 0;
+    size_t waitingProducers = 0;
 
 public:
+    /**
+     * @brief 创建无界队列。存储在需要时按倍数扩容，之后不再释放，稳定运行时不分配内存。
+     */
+    BlockingQueue() = default;
+
+    /**
+     * @brief 创建有界队列。存储在构造时一次分配，队列满时 push 会阻塞生产者（背压）。
+     * @param capacity 最大元素数量；0 表示无界。
+     */
+    explicit BlockingQueue(size_t capacity) : capacity(capacity)
+    {
+        queue.reserve(capacity);
+    }
+
+    /**
+     * @brief 推入一个元素；有界队列已满时阻塞直到有空位。
+     * @throws BlockingQueueClosed 队列已关闭（包括等待期间被关闭）。
+     */
     void push(T&& item)
     {
-        std::lock_guard lock(mutex);
-        if (closed) {
-            throw BlockingQueueClosed{};
-        }
-        queue.push_back(std::move(item));
-        
-        // 对于SPSC，只有一个消费者在等待，notify_one 是最高效的选择。
+        std::unique_lock lock(mutex);
+        waitForSpaceLocked(lock);
+        pushLocked(std::move(item));
         cv.notify_one();
     }
 
     void push(const T& item)
     {
-        std::lock_guard lock(mutex);
-        if (closed) {
-            throw BlockingQueueClosed{};
-        }
-        queue.push_back(item);
+        std::unique_lock lock(mutex);
+        waitForSpaceLocked(lock);
+        pushLocked(item);
         cv.notify_one();
     }
 
+    /**
+     * @brief 非阻塞推入；有界队列已满时返回 false，此时 item 不会被移走。
+     * @throws BlockingQueueClosed 队列已关闭。
+     */
+    bool try_push(T&& item) { return tryPush(std::move(item)); }
+    bool try_push(const T& item) { return tryPush(item); }
+
+    /**
+     * @brief 最多等待 timeout 推入；超时返回 false，此时 item 不会被移走。
+     * @throws BlockingQueueClosed 队列已关闭。
+     */
+    template <typename Rep, typename Period>
+    bool push_for(T&& item, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return pushFor(std::move(item), timeout);
+    }
+
+    template <typename Rep, typename Period>
+    bool push_for(const T& item, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return pushFor(item, timeout);
+    }
+
     T pop()
     {
         std::unique_lock lock(mutex);
@@ -94,6 +225,7 @@ public:
         {
             T item = std::move(queue.front());
             queue.pop_front();
+            onPoppedLocked(1);
             return item;
         }
 
@@ -101,6 +233,99 @@ public:
         throw BlockingQueueClosed{};
     }
 
+    /**
+     * @brief 一次加锁推入范围内的所有元素（右值范围时移动，否则复制）。
+     * 有界队列空间不足时会分批推入，期间唤醒消费者并等待空位。
+     * @return 推入的元素数量。
+     * @throws BlockingQueueClosed 队列已关闭。
+     */
+    template <typename Range>
+    size_t push_bulk(Range&& items)
+    {
+        size_t count = 0;
+        {
+            std::unique_lock lock(mutex);
+            if (closed) {
+                throw BlockingQueueClosed{};
+            }
+            for (auto&& item : items) {
+                if (fullLocked()) {
+                    cv.notify_all();
+                    waitForSpaceLocked(lock);
+                }
+                if constexpr (std::is_lvalue_reference_v<Range>) {
+                    pushLocked(item);
+                }
+                else {
+                    pushLocked(std::move(item));
+                }
+                ++count;
+            }
+        }
+        if (count == 1) {
+            cv.notify_one();
+        }
+        else if (count > 1) {
+            cv.notify_all();
+        }
+        return count;
+    }
+
+    /**
+     * @brief 阻塞直到至少有一个元素或队列关闭，然后一次加锁取出至多 max 个元素写入 out。
+     * @return 取出的元素数量；返回 0 表示队列已关闭且为空（不抛出异常）。
+     */
+    template <typename OutputIt>
+    size_t pop_bulk(OutputIt out, size_t max)
+    {
+        if (max == 0) {
+            return 0;
+        }
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&]() { return !queue.empty() || closed; });
+
+        size_t count = 0;
+        while (count < max && !queue.empty()) {
+            *out = std::move(queue.front());
+            ++out;
+            queue.pop_front();
+            ++count;
+        }
+        onPoppedLocked(count);
+        return count;
+    }
+
+    /**
+     * @brief 非阻塞地取出队首元素；队列为空时返回 std::nullopt。
+     */
+    std::optional<T> try_pop()
+    {
+        std::lock_guard lock(mutex);
+        return popFrontLocked();
+    }
+
+    /**
+     * @brief 最多等待 timeout 取出队首元素；超时或队列关闭且为空时返回 std::nullopt。
+     */
+    template <typename Rep, typename Period>
+    std::optional<T> try_pop_for(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::unique_lock lock(mutex);
+        cv.wait_for(lock, timeout, [&]() { return !queue.empty() || closed; });
+        return popFrontLocked();
+    }
+
+    /**
+     * @brief 与 pop() 相同，但队列关闭且为空时返回 std::nullopt 而不是抛出异常，
+     * 适合消费者循环：`while (auto item = queue.pop_optional()) { ... }`。
+     */
+    std::optional<T> pop_optional()
+    {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&]() { return !queue.empty() || closed; });
+        return popFrontLocked();
+    }
+
     T peek()
     {
         std::unique_lock lock(mutex);
@@ -117,9 +342,359 @@ public:
         std::lock_guard lock(mutex);
         closed = true;
         
-        // 对于SPSC，只有一个消费者需要被唤醒，所以 notify_one 足够且高效。
+        // 可能有多个线程阻塞在 pop()/peek() 或有界队列的 push() 中，必须全部唤醒。
+        cv.notify_all();
+        notFull.notify_all();
+    }
+
+    size_t size() const
+    {
+        std::lock_guard lock(mutex);
+        return queue.size();
+    }
+
+    // 最大元素数量；0 表示无界
+    size_t max_size() const { return capacity; }
+
+    // 队列长度的历史最大值，可用于判断容量是否合适
+    size_t high_water_mark() const
+    {
+        std::lock_guard lock(mutex);
+        return highWater;
+    }
+
+private:
+    bool fullLocked() const
+    {
+        return capacity != 0 && queue.size() >= capacity;
+    }
+
+    void waitForSpaceLocked(std::unique_lock<std::mutex>& lock)
+    {
+        if (fullLocked() && !closed) {
+            ++waitingProducers;
+            notFull.wait(lock, [&]() { return !fullLocked() || closed; });
+            --waitingProducers;
+        }
+        if (closed) {
+            throw BlockingQueueClosed{};
+        }
+    }
+
+    template <typename U>
+    void pushLocked(U&& item)
+    {
+        queue.push_back(std::forward<U>(item));
+        if (queue.size() > highWater) {
+            highWater = queue.size();
+        }
+    }
+
+    template <typename U>
+    bool tryPush(U&& item)
+    {
+        {
+            std::lock_guard lock(mutex);
+            if (closed) {
+                throw BlockingQueueClosed{};
+            }
+            if (fullLocked()) {
+                return false;
+            }
+            pushLocked(std::forward<U>(item));
+        }
         cv.notify_one();
+        return true;
     }
+
+    template <typename U, typename Rep, typename Period>
+    bool pushFor(U&& item, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        {
+            std::unique_lock lock(mutex);
+            if (fullLocked() && !closed) {
+                ++waitingProducers;
+                bool ready = notFull.wait_for(lock, timeout, [&]() { return !fullLocked() || closed; });
+                --waitingProducers;
+                if (!ready) {
+                    return false;
+                }
+            }
+            if (closed) {
+                throw BlockingQueueClosed{};
+            }
+            pushLocked(std::forward<U>(item));
+        }
+        cv.notify_one();
+        return true;
+    }
+
+    // 只有存在等待空位的生产者时才唤醒，无界队列或无背压时不产生额外开销
+    void onPoppedLocked(size_t count)
+    {
+        if (waitingProducers == 0 || count == 0) {
+            return;
+        }
+        if (count == 1) {
+            notFull.notify_one();
+        }
+        else {
+            notFull.notify_all();
+        }
+    }
+
+    std::optional<T> popFrontLocked()
+    {
+        if (queue.empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> item(std::move(queue.front()));
+        queue.pop_front();
+        onPoppedLocked(1);
+        return item;
+    }
+};
+
+/**
+ * @class MpmcBlockingQueue
+ * @brief 有界、无锁的多生产者多消费者 (MPMC) 阻塞队列。
+ *
+ * @tparam T 队列中存储的元素类型。
+ *
+ * 存储为 Dmitry Vyukov 风格的序列号环形数组：每个槽位带一个序列号，生产者和消费者
+ * 各自用一次 CAS 抢占位置，入队和出队在无竞争时都不加锁、不分配内存。
+ * - `try_push` / `try_pop` 永不阻塞，队列满或空时返回 false。
+ * - `push` / `pop` 先自旋重试，仍不成功才通过 C++20 原子等待挂起；
+ *   只有存在挂起的对端时才会发出唤醒，热路径上没有系统调用。
+ * - `close()` 唤醒所有挂起的生产者和消费者。关闭后 `pop` 先取完剩余元素再抛出
+ *   BlockingQueueClosed，`push` / `try_push` 直接抛出 BlockingQueueClosed。
+ *   与 close() 并发的 push 可能成功也可能抛出，生产者应在关闭前停止。
+ *
+ * <h2>使用示例</h2>
+ * @code
+ * core::MpmcBlockingQueue<Job> jobs(1024);
+ *
+ * // 多个消费者线程
+ * auto consume = [&jobs]() {
+ *     try {
+ *         for (;;) process(jobs.pop());
+ *     } catch (const core::BlockingQueueClosed&) {}
+ * };
+ *
+ * jobs.push(Job{});   // 队列满时阻塞
+ * jobs.close();       // 唤醒所有消费者
+ * @endcode
+ */
+template <typename T>
+class MpmcBlockingQueue
+{
+public:
+    /**
+     * @param capacity 队列容量，向上取整到 2 的幂（至少为 2）。
+     */
+    explicit MpmcBlockingQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        cells = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpmcBlockingQueue()
+    {
+        std::optional<T> item;
+        while (tryPopImpl(item)) {
+            item.reset();
+        }
+    }
+
+    MpmcBlockingQueue(const MpmcBlockingQueue&) = delete;
+    MpmcBlockingQueue& operator=(const MpmcBlockingQueue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    bool is_closed() const { return closed.load(std::memory_order_acquire); }
+
+    // 非阻塞入队。队列满时返回 false，此时 item 不会被移走。
+    bool try_push(T&& item) { return tryPush(std::move(item)); }
+    bool try_push(const T& item) { return tryPush(item); }
+
+    // 非阻塞出队。队列空时返回 false（无论是否已关闭）。
+    bool try_pop(T& out)
+    {
+        std::optional<T> item;
+        if (!tryPopImpl(item)) {
+            return false;
+        }
+        out = std::move(*item);
+        return true;
+    }
+
+    void push(T&& item) { pushBlocking(std::move(item)); }
+    void push(const T& item) { pushBlocking(item); }
+
+    T pop()
+    {
+        std::optional<T> item;
+        for (;;) {
+            for (int spin = 0; spin < kSpinCount; ++spin) {
+                if (tryPopImpl(item)) {
+                    return std::move(*item);
+                }
+                if (closed.load(std::memory_order_acquire)) {
+                    // 关闭之后仍要先取完剩余元素
+                    if (tryPopImpl(item)) {
+                        return std::move(*item);
+                    }
+                    throw BlockingQueueClosed{};
+                }
+                std::this_thread::yield();
+            }
+            if (park(itemSignal, waitingConsumers, [&]() { return tryPopImpl(item); })) {
+                return std::move(*item);
+            }
+        }
+    }
+
+    void close()
+    {
+        closed.store(true, std::memory_order_seq_cst);
+        itemSignal.fetch_add(1, std::memory_order_seq_cst);
+        spaceSignal.fetch_add(1, std::memory_order_seq_cst);
+        itemSignal.notify_all();
+        spaceSignal.notify_all();
+    }
+
+private:
+    static constexpr int kSpinCount = 64;
+    static constexpr size_t kCacheLine = 64;
+
+    struct alignas(kCacheLine) Cell
+    {
+        std::atomic<size_t> sequence{ 0 };
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    template <typename U>
+    bool tryPush(U&& item)
+    {
+        if (closed.load(std::memory_order_acquire)) {
+            throw BlockingQueueClosed{};
+        }
+        Cell* cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false; // 满
+            }
+            else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(std::forward<U>(item));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        signal(itemSignal, waitingConsumers);
+        return true;
+    }
+
+    bool tryPopImpl(std::optional<T>& out)
+    {
+        Cell* cell;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false; // 空
+            }
+            else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        T* slot = std::launder(reinterpret_cast<T*>(cell->storage));
+        out.emplace(std::move(*slot));
+        slot->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        signal(spaceSignal, waitingProducers);
+        return true;
+    }
+
+    template <typename U>
+    void pushBlocking(U&& item)
+    {
+        for (;;) {
+            for (int spin = 0; spin < kSpinCount; ++spin) {
+                if (tryPush(std::forward<U>(item))) {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+            if (park(spaceSignal, waitingProducers, [&]() { return tryPush(std::forward<U>(item)); })) {
+                return;
+            }
+        }
+    }
+
+    // 只有存在挂起的等待者时才唤醒。与 park() 中的 fence 配对，避免丢失唤醒。
+    void signal(std::atomic<uint32_t>& sig, std::atomic<uint32_t>& waiting)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) != 0) {
+            sig.fetch_add(1, std::memory_order_release);
+            sig.notify_one();
+        }
+    }
+
+    // 登记为等待者后再重试一次，仍失败才在 sig 上挂起。返回重试是否成功。
+    template <typename Retry>
+    bool park(std::atomic<uint32_t>& sig, std::atomic<uint32_t>& waiting, Retry&& retry)
+    {
+        struct WaiterGuard {
+            std::atomic<uint32_t>& count;
+            ~WaiterGuard() { count.fetch_sub(1, std::memory_order_relaxed); }
+        } guard{ waiting };
+        waiting.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t seen = sig.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (retry()) {
+            return true;
+        }
+        if (!closed.load(std::memory_order_acquire)) {
+            sig.wait(seen, std::memory_order_acquire);
+        }
+        return false;
+    }
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+
+    // 生产者与消费者的位置分别位于独立的缓存行，避免伪共享
+    alignas(kCacheLine) std::atomic<size_t> enqueuePos{ 0 };
+    alignas(kCacheLine) std::atomic<size_t> dequeuePos{ 0 };
+    alignas(kCacheLine) std::atomic<uint32_t> itemSignal{ 0 };
+    std::atomic<uint32_t> waitingConsumers{ 0 };
+    alignas(kCacheLine) std::atomic<uint32_t> spaceSignal{ 0 };
+    std::atomic<uint32_t> waitingProducers{ 0 };
+    alignas(kCacheLine) std::atomic<bool> closed{ false };
 };
 
 } // namespace core
\ No newline at end of file
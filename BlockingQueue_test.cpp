@@ -7,6 +7,9 @@
 #include <numeric>
 #include <future>
 #include <atomic>
+#include <memory>
+#include <iterator>
+#include <string>
 
 using namespace core;
 using namespace std::chrono_literals;
@@ -156,4 +159,249 @@ TEST_F(BlockingQueueTest, PopDrainsQueueBeforeThrowingWhenClosed) {
 
     // 4. 此时队列已空，再次调用 pop() 应该抛出异常
     ASSERT_THROW(queue.pop(), BlockingQueueClosed);
-}
\ No newline at end of file
+}
+// 11. close() 必须唤醒所有阻塞在 pop() 中的消费者
+TEST_F(BlockingQueueTest, CloseWakesAllWaitingConsumers) {
+    const int num_consumers = 4;
+    std::atomic<int> exited = 0;
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < num_consumers; ++i) {
+        consumers.emplace_back([this, &exited]() {
+            EXPECT_THROW(queue.pop(), BlockingQueueClosed);
+            exited++;
+        });
+    }
+    std::this_thread::sleep_for(50ms);
+    queue.close();
+    for (auto& t : consumers) {
+        t.join();
+    }
+    EXPECT_EQ(exited, num_consumers);
+}
+
+// --- MpmcBlockingQueue 测试 ---
+
+// 12. 容量向上取整到 2 的幂，try_push/try_pop 在满/空时返回 false
+TEST(MpmcBlockingQueueTest, TryPushAndTryPopRespectBounds) {
+    MpmcBlockingQueue<std::unique_ptr<int>> mpmc(3);
+    ASSERT_EQ(mpmc.capacity(), 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(mpmc.try_push(std::make_unique<int>(i)));
+    }
+    auto extra = std::make_unique<int>(99);
+    EXPECT_FALSE(mpmc.try_push(std::move(extra)));
+    ASSERT_NE(extra, nullptr); // 失败时不会移走元素
+
+    std::unique_ptr<int> out;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(mpmc.try_pop(out));
+        EXPECT_EQ(*out, i);
+    }
+    EXPECT_FALSE(mpmc.try_pop(out));
+}
+
+// 13. 关闭后先取完剩余元素再抛出，push 直接抛出
+TEST(MpmcBlockingQueueTest, CloseDrainsThenThrows) {
+    MpmcBlockingQueue<int> mpmc(8);
+    mpmc.push(1);
+    mpmc.push(2);
+    mpmc.close();
+    EXPECT_TRUE(mpmc.is_closed());
+    EXPECT_EQ(mpmc.pop(), 1);
+    EXPECT_EQ(mpmc.pop(), 2);
+    EXPECT_THROW(mpmc.pop(), BlockingQueueClosed);
+    EXPECT_THROW(mpmc.push(3), BlockingQueueClosed);
+    EXPECT_THROW(mpmc.try_push(3), BlockingQueueClosed);
+}
+
+// 14. close() 唤醒所有挂起的消费者和生产者
+TEST(MpmcBlockingQueueTest, CloseWakesAllParkedThreads) {
+    MpmcBlockingQueue<int> empty(4);
+    MpmcBlockingQueue<int> full(2);
+    full.push(1);
+    full.push(2);
+
+    std::atomic<int> woken = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; ++i) {
+        threads.emplace_back([&]() {
+            EXPECT_THROW(empty.pop(), BlockingQueueClosed);
+            woken++;
+        });
+        threads.emplace_back([&]() {
+            EXPECT_THROW(full.push(3), BlockingQueueClosed);
+            woken++;
+        });
+    }
+    std::this_thread::sleep_for(50ms);
+    empty.close();
+    full.close();
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(woken, 6);
+}
+
+// 15. 多生产者、多消费者并发：每个元素恰好被消费一次
+TEST(MpmcBlockingQueueTest, MultiProducerMultiConsumer) {
+    MpmcBlockingQueue<int> mpmc(64);
+    const int num_producers = 4;
+    const int num_consumers = 4;
+    const int items_per_producer = 50000;
+
+    std::atomic<long long> sum = 0;
+    std::atomic<int> count = 0;
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < num_consumers; ++i) {
+        consumers.emplace_back([&]() {
+            try {
+                for (;;) {
+                    sum += mpmc.pop();
+                    count++;
+                }
+            } catch (const BlockingQueueClosed&) {
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < items_per_producer; ++i) {
+                mpmc.push(p * items_per_producer + i);
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    mpmc.close();
+    for (auto& t : consumers) {
+        t.join();
+    }
+
+    const long long total = static_cast<long long>(num_producers) * items_per_producer;
+    EXPECT_EQ(count, total);
+    EXPECT_EQ(sum, total * (total - 1) / 2);
+}
+
+// 16. push_bulk/pop_bulk 一次处理多个元素，关闭后 pop_bulk 返回 0
+TEST_F(BlockingQueueTest, BulkPushAndPop) {
+    std::vector<int> items(10);
+    std::iota(items.begin(), items.end(), 0);
+    EXPECT_EQ(queue.push_bulk(items), 10u);
+
+    std::vector<int> out;
+    EXPECT_EQ(queue.pop_bulk(std::back_inserter(out), 4), 4u);
+    EXPECT_EQ(queue.pop_bulk(std::back_inserter(out), 100), 6u);
+    EXPECT_EQ(out, items);
+
+    queue.close();
+    EXPECT_EQ(queue.pop_bulk(std::back_inserter(out), 100), 0u);
+    EXPECT_THROW(queue.push_bulk(items), BlockingQueueClosed);
+}
+
+// 17. try_pop / try_pop_for / pop_optional 不抛出异常
+TEST_F(BlockingQueueTest, OptionalPops) {
+    EXPECT_FALSE(queue.try_pop().has_value());
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue.try_pop_for(30ms).has_value());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 30ms);
+
+    std::thread producer([this]() {
+        std::this_thread::sleep_for(20ms);
+        queue.push(7);
+    });
+    auto item = queue.try_pop_for(2s);
+    producer.join();
+    ASSERT_TRUE(item.has_value());
+    EXPECT_EQ(*item, 7);
+
+    queue.push(8);
+    queue.push(9);
+    queue.close();
+    int sum = 0;
+    while (auto next = queue.pop_optional()) {
+        sum += *next;
+    }
+    EXPECT_EQ(sum, 17);
+    EXPECT_FALSE(queue.try_pop_for(10ms).has_value());
+}
+
+// 18. 有界队列：满时 try_push/push_for 失败，push 阻塞直到消费者取走元素
+TEST(BoundedBlockingQueueTest, PushBlocksWhenFull) {
+    BlockingQueue<int> bounded(2);
+    EXPECT_EQ(bounded.max_size(), 2u);
+    bounded.push(1);
+    EXPECT_TRUE(bounded.try_push(2));
+    EXPECT_FALSE(bounded.try_push(3));
+    EXPECT_FALSE(bounded.push_for(3, 20ms));
+    EXPECT_EQ(bounded.size(), 2u);
+
+    std::atomic<bool> pushed = false;
+    std::thread producer([&]() {
+        bounded.push(3);
+        pushed = true;
+    });
+    std::this_thread::sleep_for(30ms);
+    EXPECT_FALSE(pushed);
+
+    EXPECT_EQ(bounded.pop(), 1);
+    producer.join();
+    EXPECT_TRUE(pushed);
+    EXPECT_EQ(bounded.pop(), 2);
+    EXPECT_EQ(bounded.pop(), 3);
+    EXPECT_EQ(bounded.high_water_mark(), 2u);
+}
+
+// 19. close() 唤醒阻塞在 push() 中的生产者
+TEST(BoundedBlockingQueueTest, CloseWakesBlockedProducers) {
+    BlockingQueue<int> bounded(1);
+    bounded.push(0);
+    std::vector<std::thread> producers;
+    std::atomic<int> thrown = 0;
+    for (int i = 0; i < 3; ++i) {
+        producers.emplace_back([&]() {
+            try {
+                bounded.push(1);
+            } catch (const BlockingQueueClosed&) {
+                thrown++;
+            }
+        });
+    }
+    std::this_thread::sleep_for(30ms);
+    bounded.close();
+    for (auto& t : producers) {
+        t.join();
+    }
+    EXPECT_EQ(thrown, 3);
+    EXPECT_EQ(bounded.pop(), 0);
+}
+
+// 20. 有界队列的并发生产消费与批量推入：元素不丢失且顺序不变
+TEST(BoundedBlockingQueueTest, BackpressureKeepsOrder) {
+    BlockingQueue<std::string> bounded(8);
+    const int total = 20000;
+    std::thread producer([&]() {
+        std::vector<std::string> batch;
+        for (int i = 0; i < total; ++i) {
+            batch.push_back(std::to_string(i));
+            if (batch.size() == 32) {
+                bounded.push_bulk(std::move(batch));
+                batch.clear();
+            }
+        }
+        bounded.push_bulk(std::move(batch));
+        bounded.close();
+    });
+
+    int expected = 0;
+    while (auto item = bounded.pop_optional()) {
+        ASSERT_EQ(*item, std::to_string(expected));
+        ++expected;
+    }
+    producer.join();
+    EXPECT_EQ(expected, total);
+    EXPECT_LE(bounded.high_water_mark(), 8u);
+}
@@ -0,0 +1,346 @@
+#ifndef FUTURE_H
+#define FUTURE_H
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>      // For std::future_error
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>     // For std::monostate
+
+namespace core {
+
+    template <typename T>
+    class Future;
+
+    // 延续（then）的回调接口，由下一级的共享状态直接实现，
+    // 因此注册延续不需要额外分配 std::function。
+    class FutureContinuation {
+    public:
+        virtual ~FutureContinuation() = default;
+        virtual void onParentReady() = 0;
+    };
+
+    /**
+     * @class FutureState
+     * @brief Future 的共享状态：保存结果或异常，以及至多一个延续。
+     *
+     * 通过 std::make_shared 一次分配完成。生产者一侧（执行任务的 runner）按引用计数登记，
+     * 最后一个生产者在未设置结果的情况下被销毁时（例如消息随队列退出被丢弃），
+     * 结果会被设置为 std::future_error(broken_promise)，等待者不会永远阻塞。
+     */
+    template <typename T>
+    class FutureState {
+    public:
+        using Storage = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+        virtual ~FutureState() = default;
+
+        template <typename... Args>
+        void setValue(Args&&... args) {
+            std::shared_ptr<FutureContinuation> next;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mReady) return;
+                mValue.emplace(std::forward<Args>(args)...);
+                mReady = true;
+                next = std::move(mNext);
+            }
+            mCond.notify_all();
+            if (next) next->onParentReady();
+        }
+
+        void setException(std::exception_ptr error) {
+            std::shared_ptr<FutureContinuation> next;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mReady) return;
+                mError = std::move(error);
+                mReady = true;
+                next = std::move(mNext);
+            }
+            mCond.notify_all();
+            if (next) next->onParentReady();
+        }
+
+        bool isReady() const {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mReady;
+        }
+
+        void wait() const {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCond.wait(lock, [this]() { return mReady; });
+        }
+
+        bool waitUntil(std::chrono::steady_clock::time_point deadline) const {
+            std::unique_lock<std::mutex> lock(mMutex);
+            return mCond.wait_until(lock, deadline, [this]() { return mReady; });
+        }
+
+        // 等待并取出结果；如果保存的是异常则重新抛出
+        Storage take() {
+            wait();
+            if (mError) {
+                std::rethrow_exception(mError);
+            }
+            return std::move(*mValue);
+        }
+
+        // 注册延续；如果结果已经就绪则立即触发
+        void setContinuation(std::shared_ptr<FutureContinuation> next) {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (!mReady) {
+                    assert(!mNext && "Future::then() may only be called once");
+                    mNext = std::move(next);
+                    return;
+                }
+            }
+            next->onParentReady();
+        }
+
+        void addProducer() {
+            mProducers.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void releaseProducer() {
+            if (mProducers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+            }
+        }
+
+    private:
+        mutable std::mutex mMutex;
+        mutable std::condition_variable mCond;
+        bool mReady = false;
+        std::optional<Storage> mValue;
+        std::exception_ptr mError;
+        std::shared_ptr<FutureContinuation> mNext;
+        std::atomic<int> mProducers{ 0 };
+    };
+
+    // 调用 fn 并把结果（或异常）写入 state
+    template <typename R, typename F, typename... Args>
+    void fulfillFutureState(FutureState<R>& state, F& fn, Args&&... args) {
+        try {
+            if constexpr (std::is_void_v<R>) {
+                fn(std::forward<Args>(args)...);
+                state.setValue();
+            }
+            else {
+                state.setValue(fn(std::forward<Args>(args)...));
+            }
+        }
+        catch (...) {
+            state.setException(std::current_exception());
+        }
+    }
+
+    // submit() 使用的共享状态：任务本身与结果放在同一次分配中
+    template <typename R, typename F>
+    class FutureTaskState : public FutureState<R> {
+    public:
+        explicit FutureTaskState(F fn) : mFn(std::move(fn)) {}
+
+        void execute() {
+            fulfillFutureState(*this, mFn);
+        }
+
+    private:
+        F mFn;
+    };
+
+    /**
+     * @class FutureStateRunner
+     * @brief 投递到 Looper 的可调用对象，执行 State::execute()。
+     *
+     * 作为 State 的生产者登记引用计数：如果它在执行前被销毁（投递失败或被队列丢弃），
+     * 对应的 Future 会收到 broken_promise。
+     */
+    template <typename State>
+    class FutureStateRunner {
+    public:
+        explicit FutureStateRunner(std::shared_ptr<State> state) : mState(std::move(state)) {
+            mState->addProducer();
+        }
+
+        FutureStateRunner(const FutureStateRunner& other) : mState(other.mState) {
+            if (mState) mState->addProducer();
+        }
+
+        FutureStateRunner(FutureStateRunner&& other) noexcept : mState(std::move(other.mState)) {}
+
+        FutureStateRunner& operator=(const FutureStateRunner&) = delete;
+        FutureStateRunner& operator=(FutureStateRunner&&) = delete;
+
+        ~FutureStateRunner() {
+            if (mState) mState->releaseProducer();
+        }
+
+        void operator()() {
+            mState->execute();
+        }
+
+    private:
+        std::shared_ptr<State> mState;
+    };
+
+    // then() 的结果类型：父 Future 为 void 时 fn 不带参数
+    template <typename T, typename F>
+    struct FutureThenResult {
+        using type = std::invoke_result_t<std::decay_t<F>&, T>;
+    };
+
+    template <typename F>
+    struct FutureThenResult<void, F> {
+        using type = std::invoke_result_t<std::decay_t<F>&>;
+    };
+
+    // then() 使用的共享状态：既是下一级 Future 的状态，也是父状态的延续
+    template <typename T, typename U, typename F, typename Executor>
+    class FutureThenState : public FutureState<U>,
+        public FutureContinuation,
+        public std::enable_shared_from_this<FutureThenState<T, U, F, Executor>> {
+    public:
+        FutureThenState(std::shared_ptr<FutureState<T>> parent, F fn, Executor* executor)
+            : mParent(std::move(parent)), mFn(std::move(fn)), mExecutor(executor) {}
+
+        void onParentReady() override {
+            if (!mExecutor) {
+                execute();
+                return;
+            }
+            // 投递失败时 runner 随之销毁，下一级 Future 会收到 broken_promise
+            mExecutor->post(FutureStateRunner<FutureThenState>(this->shared_from_this()));
+        }
+
+        void execute() {
+            std::shared_ptr<FutureState<T>> parent = std::move(mParent);
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    parent->take();
+                    fulfillFutureState(*this, mFn);
+                }
+                else {
+                    fulfillFutureState(*this, mFn, parent->take());
+                }
+            }
+            catch (...) {
+                // 父 Future 的异常直接传递，不调用 fn
+                this->setException(std::current_exception());
+            }
+        }
+
+    private:
+        std::shared_ptr<FutureState<T>> mParent;
+        F mFn;
+        Executor* mExecutor;
+    };
+
+    // 无执行器的 then()：延续在完成父任务的线程上内联执行
+    struct InlineFutureExecutor {
+        template <typename Fn>
+        bool post(Fn&&) { return false; }
+    };
+
+    /**
+     * @class Future
+     * @brief 轻量的单次结果 Future，由 WorkerThread::submit() 等返回。
+     *
+     * 与 std::future 相比，共享状态只需一次分配，并支持 then() 延续：
+     * 延续可以指定在某个 Looper（Handler、WorkerThread 等任何提供 post() 的对象）上执行，
+     * 从而无需阻塞即可把工作串联到不同的线程。
+     *
+     * <h2>使用示例</h2>
+     * @code
+     * core::WorkerThread decoder("Decoder"), writer("Writer");
+     * decoder.start();
+     * writer.start();
+     *
+     * auto done = decoder.submit([]() { return decodeFrame(); })
+     *     .then(writer, [](Frame frame) { return writeFrame(frame); });
+     *
+     * bool ok = done.get(); // 阻塞等待最终结果
+     * @endcode
+     */
+    template <typename T>
+    class Future {
+    public:
+        Future() = default;
+        explicit Future(std::shared_ptr<FutureState<T>> state) : mState(std::move(state)) {}
+
+        Future(Future&&) noexcept = default;
+        Future& operator=(Future&&) noexcept = default;
+        Future(const Future&) = delete;
+        Future& operator=(const Future&) = delete;
+
+        // 是否关联了共享状态；get() 或 then() 之后变为 false
+        bool valid() const { return mState != nullptr; }
+
+        bool isReady() const { return mState && mState->isReady(); }
+
+        void wait() const { mState->wait(); }
+
+        template <typename Rep, typename Period>
+        bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const {
+            return mState->waitUntil(std::chrono::steady_clock::now() + timeout);
+        }
+
+        /**
+         * @brief 阻塞直到结果就绪并取出；任务抛出的异常会在这里重新抛出。调用后 Future 失效。
+         */
+        T get() {
+            std::shared_ptr<FutureState<T>> state = std::move(mState);
+            if constexpr (std::is_void_v<T>) {
+                state->take();
+            }
+            else {
+                return state->take();
+            }
+        }
+
+        /**
+         * @brief 注册一个在结果就绪后内联执行的延续（在完成本 Future 的线程上执行）。
+         * 如果本 Future 以异常结束，fn 不会被调用，异常传递给返回的 Future。调用后本 Future 失效。
+         */
+        template <typename F>
+        auto then(F&& fn) -> Future<typename FutureThenResult<T, F>::type> {
+            return thenImpl<InlineFutureExecutor>(nullptr, std::forward<F>(fn));
+        }
+
+        /**
+         * @brief 注册一个投递到 executor 上执行的延续。
+         * @param executor 任何提供 bool post(std::function<void()>) 的对象，例如 Handler 或 WorkerThread。
+         *        它必须比延续活得更久。投递失败时返回的 Future 收到 broken_promise。
+         */
+        template <typename Executor, typename F>
+        auto then(Executor& executor, F&& fn) -> Future<typename FutureThenResult<T, F>::type> {
+            return thenImpl<Executor>(&executor, std::forward<F>(fn));
+        }
+
+    private:
+        template <typename Executor, typename F>
+        auto thenImpl(Executor* executor, F&& fn) -> Future<typename FutureThenResult<T, F>::type> {
+            using U = typename FutureThenResult<T, F>::type;
+            using State = FutureThenState<T, U, std::decay_t<F>, Executor>;
+            std::shared_ptr<FutureState<T>> parent = std::move(mState);
+            auto next = std::make_shared<State>(parent, std::forward<F>(fn), executor);
+            Future<U> result(next);
+            // 如果父状态已就绪，这里会立即触发延续
+            parent->setContinuation(std::move(next));
+            return result;
+        }
+
+        std::shared_ptr<FutureState<T>> mState;
+    };
+
+} // namespace core
+
+#endif // FUTURE_H
@@ -1,83 +1,360 @@
 ﻿#include "HandlerThread.h" // 包含对应的头文件
 #include <iostream>         // 为了 std::cerr
 #include <stdexcept>        // 为了 std::runtime_error
+#include <cstring>          // 为了 std::strerror
+#include <cerrno>           // 为了 errno
+#include <mutex>            // 为了 std::mutex (预热池)
+#include <condition_variable>
+#include "Numa.h"
+
+#if defined(_WIN32)
+#include <windows.h>        // SetThreadDescription, SetThreadAffinityMask, SetThreadPriority
+#else
+#include <sched.h>          // sched_param, SCHED_FIFO, SCHED_RR
+#include <sys/resource.h>   // setpriority
+#if defined(__linux__)
+#include <sys/syscall.h>    // SYS_gettid
+#include <unistd.h>
+#endif
+#endif
 
 namespace core {
 
+    // --- 预热线程池 ---
+
+    // 一个已经创建好、正在等待被 HandlerThread 接管的线程
+    struct SpareThread {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable cond;
+        HandlerThread* owner = nullptr; // 接管者；设置后该线程开始执行 owner 的 run()
+        bool shutdown = false;
+    };
+
+    // 进程级的空闲线程池。进程退出时唤醒并 join 所有仍未被接管的线程。
+    class SpareThreadPool {
+    public:
+        ~SpareThreadPool() {
+            std::vector<std::shared_ptr<SpareThread>> spares;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                spares.swap(mSpares);
+            }
+            for (auto& spare : spares) {
+                {
+                    std::lock_guard<std::mutex> lock(spare->mutex);
+                    spare->shutdown = true;
+                }
+                spare->cond.notify_one();
+                spare->thread.join();
+            }
+        }
+
+        void add(std::shared_ptr<SpareThread> spare) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mSpares.push_back(std::move(spare));
+        }
+
+        std::shared_ptr<SpareThread> take() {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mSpares.empty()) {
+                return nullptr;
+            }
+            auto spare = std::move(mSpares.back());
+            mSpares.pop_back();
+            return spare;
+        }
+
+        size_t size() {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mSpares.size();
+        }
+
+    private:
+        std::mutex mMutex;
+        std::vector<std::shared_ptr<SpareThread>> mSpares;
+    };
+
+    static SpareThreadPool& sparePool() {
+        static SpareThreadPool pool;
+        return pool;
+    }
+
+    void HandlerThread::prewarm(size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            auto spare = std::make_shared<SpareThread>();
+            spare->thread = std::thread([spare]() {
+                HandlerThread* owner = nullptr;
+                {
+                    std::unique_lock<std::mutex> lock(spare->mutex);
+                    spare->cond.wait(lock, [&]() { return spare->owner || spare->shutdown; });
+                    owner = spare->owner;
+                }
+                if (owner) {
+                    owner->run();
+                }
+            });
+            sparePool().add(std::move(spare));
+        }
+    }
+
+    size_t HandlerThread::spareThreadCount() {
+        return sparePool().size();
+    }
+
+    // --- HandlerThread 实现 ---
+
+    // 其余选项保持默认值（不用聚合初始化，以免 -Wmissing-field-initializers 警告）
+    static HandlerThread::Options optionsWithName(const std::string& name) {
+        HandlerThread::Options options;
+        options.name = name;
+        return options;
+    }
+
     HandlerThread::HandlerThread(const std::string& name)
-        // `mLooperPromise` 和 `mLooperFuture` 是实现线程安全初始化的关键。
-        // `mLooperPromise` 会被新启动的线程 `run()` 用来设置 Looper 的值（或异常）。
-        // `mLooperFuture` 则被 `getLooper()` 方法用来等待并获取这个值。
-        // 使用 `share()` 将 future 转换为 `shared_future`，允许多次调用 `get()`。
-        : mName(name), mLooper(nullptr), mLooperFuture(mLooperPromise.get_future().share()) {
+        : HandlerThread(optionsWithName(name)) {
+    }
+
+    HandlerThread::HandlerThread(Options options)
+        : mOptions(std::move(options)), mLooper(nullptr) {
+        mName = mOptions.name;
     }
 
     HandlerThread::~HandlerThread() {
-        if (mThread.joinable()) {
+        if (isJoinable()) {
             quit();
             join();
         }
     }
 
+    bool HandlerThread::isJoinable() const {
+#if !defined(_WIN32)
+        if (mNativeJoinable) {
+            return true;
+        }
+#endif
+        return mThread.joinable();
+    }
+
     void HandlerThread::start() {
-        if (mThread.joinable()) {
+        if (isJoinable()) {
+            return;
+        }
+        mLooper.reset();
+        mLooperState.store(kStarting, std::memory_order_relaxed);
+#if !defined(_WIN32)
+        if (mOptions.stackSize > 0) {
+            pthread_attr_t attr;
+            pthread_attr_init(&attr);
+            int err = pthread_attr_setstacksize(&attr, mOptions.stackSize);
+            if (err == 0) {
+                err = pthread_create(&mNativeThread, &attr, [](void* self) -> void* {
+                    static_cast<HandlerThread*>(self)->run();
+                    return nullptr;
+                }, this);
+            }
+            pthread_attr_destroy(&attr);
+            if (err == 0) {
+                mNativeJoinable = true;
+                return;
+            }
+            std::cerr << "HandlerThread (" << mName << ") failed to apply stack size "
+                << mOptions.stackSize << ": " << std::strerror(err) << ", using default." << std::endl;
+        }
+        else
+#endif
+        if (auto spare = sparePool().take()) {
+            // 接管预热线程：转移 std::thread 的所有权，然后唤醒它执行 run()
+            mThread = std::move(spare->thread);
+            {
+                std::lock_guard<std::mutex> lock(spare->mutex);
+                spare->owner = this;
+            }
+            spare->cond.notify_one();
             return;
         }
         mThread = std::thread(&HandlerThread::run, this);
     }
 
+    size_t HandlerThread::startAll(std::span<HandlerThread* const> threads) {
+        // 先发起全部启动，再统一等待，各线程的 Looper 准备过程因此可以并行
+        for (HandlerThread* thread : threads) {
+            if (thread) thread->start();
+        }
+        size_t ready = 0;
+        for (HandlerThread* thread : threads) {
+            if (thread && thread->waitUntilReady()) ++ready;
+        }
+        return ready;
+    }
+
+    void HandlerThread::applyOptions() {
+        // NUMA 节点决定默认的 CPU 集合，所以要在设置亲和性之前处理
+        std::vector<int> cpus = mOptions.cpus;
+        mNumaNode = -1;
+        if (mOptions.numaNode >= 0) {
+            std::vector<int> nodeCpus = Numa::nodeCpus(mOptions.numaNode);
+            if (mOptions.numaNode < Numa::nodeCount() && !nodeCpus.empty()) {
+                if (cpus.empty()) {
+                    cpus = std::move(nodeCpus);
+                }
+                // 线程后续的分配（包括 Looper::prepare() 创建的队列）优先落在该节点
+                Numa::setPreferredNode(mOptions.numaNode);
+                mNumaNode = mOptions.numaNode;
+            }
+            else {
+                std::cerr << "HandlerThread (" << mName << ") NUMA node " << mOptions.numaNode
+                    << " is not available, running without NUMA binding." << std::endl;
+            }
+        }
+
+#if defined(_WIN32)
+        HANDLE self = GetCurrentThread();
+        if (!mName.empty()) {
+            std::wstring wname(mName.begin(), mName.end());
+            SetThreadDescription(self, wname.c_str());
+        }
+        if (!cpus.empty()) {
+            DWORD_PTR mask = 0;
+            for (int cpu : cpus) {
+                if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+                    mask |= static_cast<DWORD_PTR>(1) << cpu;
+                }
+            }
+            if (!mask || !SetThreadAffinityMask(self, mask)) {
+                std::cerr << "HandlerThread (" << mName << ") failed to set CPU affinity." << std::endl;
+            }
+        }
+        if (mOptions.policy != SchedPolicy::Inherit) {
+            // Windows 没有 SCHED_FIFO/nice，映射到最接近的线程优先级
+            int priority = THREAD_PRIORITY_NORMAL;
+            if (mOptions.policy == SchedPolicy::Normal) {
+                priority = mOptions.priority < 0 ? THREAD_PRIORITY_ABOVE_NORMAL
+                    : mOptions.priority > 0 ? THREAD_PRIORITY_BELOW_NORMAL : THREAD_PRIORITY_NORMAL;
+            }
+            else {
+                priority = THREAD_PRIORITY_TIME_CRITICAL;
+            }
+            if (!SetThreadPriority(self, priority)) {
+                std::cerr << "HandlerThread (" << mName << ") failed to set thread priority." << std::endl;
+            }
+        }
+#else
+        pthread_t self = pthread_self();
+        if (!mName.empty()) {
+#if defined(__APPLE__)
+            pthread_setname_np(mName.substr(0, 63).c_str());
+#else
+            // Linux 的线程名最长 16 字节（含结尾的 '\0'）
+            pthread_setname_np(self, mName.substr(0, 15).c_str());
+#endif
+        }
+        if (!cpus.empty()) {
+#if defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            int err = pthread_setaffinity_np(self, sizeof(set), &set);
+            if (err != 0) {
+                std::cerr << "HandlerThread (" << mName << ") failed to set CPU affinity: "
+                    << std::strerror(err) << std::endl;
+            }
+#else
+            std::cerr << "HandlerThread (" << mName << ") CPU affinity is not supported on this platform." << std::endl;
+#endif
+        }
+        if (mOptions.policy == SchedPolicy::Fifo || mOptions.policy == SchedPolicy::RoundRobin) {
+            sched_param param{};
+            param.sched_priority = mOptions.priority;
+            int policy = mOptions.policy == SchedPolicy::Fifo ? SCHED_FIFO : SCHED_RR;
+            int err = pthread_setschedparam(self, policy, &param);
+            if (err != 0) {
+                std::cerr << "HandlerThread (" << mName << ") failed to set real-time priority: "
+                    << std::strerror(err) << std::endl;
+            }
+        }
+        else if (mOptions.policy == SchedPolicy::Normal) {
+            sched_param param{};
+            pthread_setschedparam(self, SCHED_OTHER, &param);
+#if defined(__linux__)
+            // Linux 上 nice 值是按线程生效的
+            if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), mOptions.priority) != 0) {
+                std::cerr << "HandlerThread (" << mName << ") failed to set nice value: "
+                    << std::strerror(errno) << std::endl;
+            }
+#endif
+        }
+#endif
+    }
+
     void HandlerThread::run() {
         // 1. 调用 `Looper::prepare()` 为当前线程创建一个 Looper。
-        // 2. 通过 `mLooperPromise.set_value()` 将创建好的 Looper “发布”出去，
-        //    这样等待在 `mLooperFuture` 上的 `getLooper()` 调用就可以收到了。
+        // 2. 写入 mLooper 并回调 onLooperPrepared()，然后以 release 语义将 mLooperState 置为 kReady，
+        //    这样等待在 mLooperState 上的 `getLooper()` 调用就会被唤醒，并能看到上面写入的所有内容。
         // 3. 调用 `Looper::loop()` 进入消息循环，阻塞直到 `quit()` 被调用。
-        // 使用 try-catch 块是为了在 Looper 准备失败时，能将异常传递出去。
+        // 使用 try-catch 块是为了在 Looper 准备失败时，能将失败状态通知给等待者。
+#if !defined(_WIN32)
+        // 不能依赖 mNativeJoinable 判断：它在 pthread_create 返回后才被设置，可能晚于这里
+        mNativeThreadId.store(std::this_thread::get_id());
+        mNativeThreadId.notify_all();
+#endif
+        applyOptions();
         try {
-            Looper::prepare();
+            Looper::prepare(mNumaNode);
 
             auto myLooper = Looper::myLooper();
             if (!myLooper) {
                 throw std::runtime_error("Looper::myLooper() returned null after prepare()");
             }
 
-            mLooperPromise.set_value(myLooper);
+            mLooper = myLooper;
+            onLooperPrepared();
+
+            mLooperState.store(kReady, std::memory_order_release);
+            mLooperState.notify_all();
 
             Looper::loop();
 
         }
+        catch (const std::exception& e) {
+            failLooper(e.what());
+        }
         catch (...) {
-            // 如果 `prepare` 或 `loop` 的早期阶段失败，捕获异常并通过 promise 传递。
-            // 这样，在主线程调用 `getLooper()` 时就会重新抛出这个异常，调用者就能知道失败了。
-            try {
-                mLooperPromise.set_exception(std::current_exception());
-            }
-            catch (...) {
-                // Failsafe in case set_exception itself throws.
-            }
+            failLooper("unknown exception");
         }
     }
 
-    std::shared_ptr<Looper> HandlerThread::getLooper() {
-        if (!mThread.joinable()) {
-            return nullptr;
+    void HandlerThread::failLooper(const char* reason) {
+        // 只有在 Looper 发布之前的失败才需要通知等待者；loop() 中的异常已由 Looper 自行处理
+        if (mLooperState.load(std::memory_order_relaxed) != kStarting) {
+            return;
         }
+        std::cerr << "HandlerThread (" << mName << ") failed to create Looper: " << reason << std::endl;
+        mLooper.reset();
+        mLooperState.store(kFailed, std::memory_order_release);
+        mLooperState.notify_all();
+    }
 
-        std::lock_guard<std::mutex> lock(mMutex);
-        if (!mLooper) {            
-            // 第一次调用 `getLooper()` 时，`mLooper` 是 nullptr。
-            // 此时，它会调用 `mLooperFuture.get()`。这个调用会阻塞，直到 `run()` 方法在新线程中
-            // 调用了 `mLooperPromise.set_value()` 或 `set_exception()`。
-            // 这就完美地解决了时序问题：保证了 `getLooper()` 返回时，Looper 必定已经被安全地创建好了。
-            // 后续再次调用 `getLooper()` 时，`mLooper` 已经有值，会直接返回缓存的指针，不会再阻塞。
-            try {
-                mLooper = mLooperFuture.get();
-            }
-            catch (const std::exception& e) {
-                std::cerr << "HandlerThread (" << mName << ") failed to create Looper: " << e.what() << std::endl;
-                mLooper = nullptr;
-            }
+    bool HandlerThread::waitUntilReady() {
+        if (!isJoinable()) {
+            return false;
+        }
+        // 快速路径：Looper 已发布后只是一次 acquire 读取，不加锁也不阻塞
+        int state = mLooperState.load(std::memory_order_acquire);
+        if (state == kStarting) {
+            mLooperState.wait(kStarting, std::memory_order_acquire);
+            state = mLooperState.load(std::memory_order_acquire);
         }
-        return mLooper;
+        return state == kReady;
+    }
+
+    std::shared_ptr<Looper> HandlerThread::getLooper() {
+        // mLooper 在发布后不再被修改，因此可以并发地无锁复制
+        return waitUntilReady() ? mLooper : nullptr;
     }
 
     bool HandlerThread::quit() {
@@ -89,13 +366,37 @@ namespace core {
         return false;
     }
 
+    bool HandlerThread::quitSafely() {
+        std::shared_ptr<Looper> looper = getLooper();
+        if (looper) {
+            looper->quitSafely();
+            return true;
+        }
+        return false;
+    }
+
     void HandlerThread::join() {
+#if !defined(_WIN32)
+        if (mNativeJoinable) {
+            pthread_join(mNativeThread, nullptr);
+            mNativeJoinable = false;
+            mNativeThreadId.store(std::thread::id{});
+            return;
+        }
+#endif
         if (mThread.joinable()) {
             mThread.join();
         }
     }
 
     std::thread::id HandlerThread::getThreadId() const {
+#if !defined(_WIN32)
+        if (mNativeJoinable) {
+            // pthread_t 无法直接转换为 std::thread::id，等待新线程在 run() 中发布自己的 ID
+            mNativeThreadId.wait(std::thread::id{});
+            return mNativeThreadId.load();
+        }
+#endif
         return mThread.get_id();
     }
 
@@ -4,9 +4,14 @@
 #include "looper_handler.h" // 依赖 Looper
 #include <thread>
 #include <string>
-#include <future>   // For std::promise and std::shared_future
 #include <memory>   // For std::shared_ptr
-#include <mutex>    // For std::mutex
+#include <vector>   // For std::vector (Options::cpus)
+#include <atomic>   // For std::atomic
+#include <span>     // For std::span (startAll)
+
+#if !defined(_WIN32)
+#include <pthread.h> // For pthread_t (Options::stackSize)
+#endif
 
 namespace core {
 
@@ -39,12 +44,54 @@ namespace core {
      */
     class HandlerThread {
     public:
+        /**
+         * @brief 线程的调度策略。
+         */
+        enum class SchedPolicy {
+            Inherit,    ///< 不修改，沿用创建者线程的调度设置
+            Normal,     ///< 普通分时调度（SCHED_OTHER），priority 为 nice 值（-20..19）
+            Fifo,       ///< 实时调度 SCHED_FIFO，priority 为实时优先级（1..99）
+            RoundRobin, ///< 实时调度 SCHED_RR，priority 为实时优先级（1..99）
+        };
+
+        /**
+         * @brief HandlerThread 的线程选项，在 run() 中 Looper::prepare() 之前应用。
+         *
+         * 设置失败（例如没有 CAP_SYS_NICE 权限时设置 SCHED_FIFO）只会打印警告，线程仍会正常启动。
+         *
+         * @code
+         * core::HandlerThread::Options options;
+         * options.name = "AudioLooper";
+         * options.cpus = { 2 };
+         * options.policy = core::HandlerThread::SchedPolicy::Fifo;
+         * options.priority = 10;
+         * core::HandlerThread thread(options);
+         * @endcode
+         */
+        struct Options {
+            std::string name = "HandlerThread"; ///< 线程名，同时设置为 OS 线程名（Linux 上截断为 15 个字符）
+            std::vector<int> cpus;              ///< 允许运行的 CPU 编号，为空表示不限制
+            SchedPolicy policy = SchedPolicy::Inherit;
+            int priority = 0;                   ///< 含义取决于 policy
+            size_t stackSize = 0;               ///< 线程栈大小（字节），0 表示系统默认值；仅 POSIX 平台生效
+            /// 绑定的 NUMA 节点，-1 表示不绑定。绑定后线程只在该节点的 CPU 上运行（cpus 为空时），
+            /// 线程的内存优先从该节点分配，Looper 的队列存储也放在该节点上。
+            /// 节点不存在或系统不支持 NUMA 时退化为不绑定，可通过 Looper::getNumaNode() 查询实际结果。
+            int numaNode = -1;
+        };
+
         /**
          * @brief 构造函数。
          * @param name 线程的描述性名称。
          */
         explicit HandlerThread(const std::string& name = "HandlerThread");
 
+        /**
+         * @brief 使用完整的线程选项构造。
+         * @param options 线程名、CPU 亲和性、调度策略与栈大小等选项。
+         */
+        explicit HandlerThread(Options options);
+
         /**
          * @brief 析构函数。
          *
@@ -61,12 +108,38 @@ namespace core {
 
         /**
          * @brief 启动线程。
+         *
+         * 不会等待 Looper 准备完成；如果预热池（见 prewarm()）中有空闲线程，会直接接管它而不是新建线程。
          */
         void start();
 
+        /**
+         * @brief 批量启动多个 HandlerThread，并只等待一次。
+         *
+         * 先依次发起所有线程的启动，再统一等待它们的 Looper 就绪，
+         * 使各线程的创建和 Looper 准备过程并行进行，而不是逐个串行等待。
+         * @return 成功就绪的线程数量。
+         */
+        static size_t startAll(std::span<HandlerThread* const> threads);
+
+        /**
+         * @brief 预先创建 count 个空闲线程放入进程级的预热池。
+         *
+         * 之后调用 start() 的 HandlerThread 会优先接管池中的线程，省去创建线程的开销。
+         * 指定了 Options::stackSize 的 HandlerThread 不会使用预热线程。
+         */
+        static void prewarm(size_t count);
+
+        /**
+         * @brief 预热池中当前空闲线程的数量。
+         */
+        static size_t spareThreadCount();
+
         /**
          * @brief 获取与此 HandlerThread 关联的 Looper。
-         * @return 指向此线程 Looper 的共享指针。
+         *
+         * 首次调用会等待 Looper 准备完成；之后只是一次原子读取，不加锁。
+         * @return 指向此线程 Looper 的共享指针；线程未启动或 Looper 创建失败时返回 nullptr。
          */
         std::shared_ptr<Looper> getLooper();
 
@@ -76,6 +149,12 @@ namespace core {
          */
         bool quit();
 
+        /**
+         * @brief 请求 Looper 安全退出：已到期的消息会处理完，延迟消息被丢弃。
+         * @return 如果 Looper 存在则返回 true，否则返回 false。
+         */
+        bool quitSafely();
+
         /**
          * @brief 等待线程终止。
          */
@@ -87,20 +166,58 @@ namespace core {
          */
         std::thread::id getThreadId() const;
 
+    protected:
+        /**
+         * @brief 在 Looper 准备完成、发布给 getLooper() 之前，于该线程上回调（对应 Android 的 onLooperPrepared）。
+         *
+         * 子类可以在这里创建与 Looper 绑定的对象；这些对象对 getLooper() 返回后的调用者可见。
+         * 覆盖此方法的子类必须在自己的析构函数中停止并 join 线程。
+         */
+        virtual void onLooperPrepared() {}
+
+        /**
+         * @brief 等待 Looper 准备完成。
+         * @return Looper 已就绪返回 true；线程未启动或 Looper 创建失败返回 false。
+         */
+        bool waitUntilReady();
+
     private:
         /**
          * @brief 线程的主执行函数。
          */
         void run();
 
+        /**
+         * @brief 将 mOptions 应用到当前线程（名称、亲和性、调度策略）。
+         */
+        void applyOptions();
+
+        /**
+         * @brief 线程是否已启动且尚未被 join。
+         */
+        bool isJoinable() const;
+
+        /**
+         * @brief Looper 发布之前失败时，记录原因并唤醒等待者。
+         */
+        void failLooper(const char* reason);
+
+        Options mOptions;
+        int mNumaNode = -1; // 实际生效的 NUMA 节点，由 applyOptions() 设置
         std::string mName;
         std::thread mThread;
-        std::shared_ptr<Looper> mLooper;
-
-        std::promise<std::shared_ptr<Looper>> mLooperPromise;
-        std::shared_future<std::shared_ptr<Looper>> mLooperFuture;
 
-        std::mutex mMutex;
+#if !defined(_WIN32)
+        // 指定了 stackSize 时，线程通过 pthread_create 创建（std::thread 无法设置栈大小）
+        pthread_t mNativeThread{};
+        bool mNativeJoinable = false;
+        std::atomic<std::thread::id> mNativeThreadId{};
+#endif
+        // mLooper 由 run() 写入一次，随后以 release 语义发布 mLooperState；
+        // 读者以 acquire 读到 Ready 后即可无锁地读取 mLooper。
+        enum LooperState : int { kStarting, kReady, kFailed };
+        std::shared_ptr<Looper> mLooper;
+        std::atomic<int> mLooperState{ kStarting };
     };
 
 } // namespace core
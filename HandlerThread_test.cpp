@@ -1,5 +1,6 @@
 ﻿#include "gtest/gtest.h"
 #include "HandlerThread.h"
+#include "Numa.h"
  
 #include <future>
 #include <chrono>
@@ -114,4 +115,171 @@ TEST_F(HandlerThreadTest, QuitAndJoin) {
 
     // join() 成功返回后，线程应该已经结束。
     // 注意：我们无法直接检查线程是否“存活”，但 join 的成功返回就是最好的证明。
-}
\ No newline at end of file
+}
+
+// 测试5: 验证 Options 中的线程名和 CPU 亲和性被应用到 OS 线程
+// 目标: 覆盖 HandlerThread(Options)
+#if defined(__linux__)
+TEST(HandlerThreadOptionsTest, AppliesNameAndAffinity) {
+    core::HandlerThread::Options options;
+    options.name = "OptionsTestLooperThread"; // 超过 15 个字符，会被截断
+
+    // 容器或 cpuset 可能不包含 CPU 0，使用当前线程允许的第一个 CPU
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+    int cpu = 0;
+    while (cpu < CPU_SETSIZE && !CPU_ISSET(cpu, &allowed)) {
+        ++cpu;
+    }
+    ASSERT_LT(cpu, CPU_SETSIZE);
+    options.cpus = { cpu };
+
+    core::HandlerThread thread(options);
+    thread.start();
+    auto looper = thread.getLooper();
+    ASSERT_NE(looper, nullptr);
+
+    auto handler = std::make_shared<TestHandler>(looper);
+    std::promise<std::pair<std::string, bool>> result_promise;
+    auto result_future = result_promise.get_future();
+    handler->post([&]() {
+        char name[16] = {};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+        result_promise.set_value({ name, CPU_COUNT(&set) == 1 && CPU_ISSET(cpu, &set) });
+    });
+
+    ASSERT_EQ(result_future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    auto [name, pinned] = result_future.get();
+    EXPECT_EQ(name, "OptionsTestLoop");
+    EXPECT_TRUE(pinned);
+
+    thread.quit();
+    thread.join();
+}
+#endif
+
+// 测试6: 指定栈大小时线程仍能正常启动、处理消息并退出
+// 目标: 覆盖 Options::stackSize 与 getThreadId()
+TEST(HandlerThreadOptionsTest, CustomStackSize) {
+    core::HandlerThread::Options options;
+    options.name = "StackSizeThread";
+    options.stackSize = 256 * 1024;
+
+    core::HandlerThread thread(options);
+    thread.start();
+    auto worker_thread_id = thread.getThreadId();
+    ASSERT_NE(worker_thread_id, std::thread::id{});
+    ASSERT_NE(worker_thread_id, std::this_thread::get_id());
+
+    auto looper = thread.getLooper();
+    ASSERT_NE(looper, nullptr);
+    EXPECT_EQ(looper->getThreadId(), worker_thread_id);
+
+    auto handler = std::make_shared<TestHandler>(looper);
+    auto future = handler->executed_thread_id_promise.get_future();
+    handler->sendMessage(handler->obtainMessage(1));
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_EQ(future.get(), worker_thread_id);
+
+    ASSERT_TRUE(thread.quit());
+    thread.join();
+}
+
+// 测试7: 绑定 NUMA 节点后 Looper 报告该节点；不存在的节点退化为不绑定
+// 目标: 覆盖 Options::numaNode 与 Looper::getNumaNode()
+TEST(HandlerThreadOptionsTest, NumaNodeBindingAndFallback) {
+    core::HandlerThread::Options options;
+    options.name = "NumaThread";
+    options.numaNode = 0;
+    core::HandlerThread bound(options);
+
+    options.numaNode = 4096; // 不存在的节点
+    core::HandlerThread fallback(options);
+
+    bound.start();
+    fallback.start();
+
+    auto bound_looper = bound.getLooper();
+    auto fallback_looper = fallback.getLooper();
+    ASSERT_NE(bound_looper, nullptr);
+    ASSERT_NE(fallback_looper, nullptr);
+
+    // 单节点或不支持 NUMA 的机器上节点 0 可能无法绑定，此时同样退化为 -1
+    int bound_node = bound_looper->getNumaNode();
+    EXPECT_TRUE(bound_node == 0 || bound_node == -1);
+    if (core::Numa::nodeCpus(0).empty()) {
+        EXPECT_EQ(bound_node, -1);
+    }
+    EXPECT_EQ(fallback_looper->getNumaNode(), -1);
+
+    // 无论是否绑定成功，消息都应正常处理
+    for (auto& looper : { bound_looper, fallback_looper }) {
+        auto handler = std::make_shared<TestHandler>(looper);
+        auto future = handler->executed_thread_id_promise.get_future();
+        handler->sendMessage(handler->obtainMessage(1));
+        ASSERT_EQ(future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+        EXPECT_EQ(future.get(), looper->getThreadId());
+    }
+
+    bound.quit();
+    fallback.quit();
+    bound.join();
+    fallback.join();
+}
+
+// 测试8: 预热线程被 start() 接管，startAll() 批量启动并只等待一次
+// 目标: 覆盖 prewarm()、spareThreadCount() 与 startAll()
+TEST(HandlerThreadStartupTest, StartAllAdoptsPrewarmedThreads) {
+    size_t spares_before = core::HandlerThread::spareThreadCount();
+    core::HandlerThread::prewarm(2);
+    ASSERT_EQ(core::HandlerThread::spareThreadCount(), spares_before + 2);
+
+    std::vector<std::unique_ptr<core::HandlerThread>> threads;
+    std::vector<core::HandlerThread*> raw_threads;
+    for (int i = 0; i < 3 + static_cast<int>(spares_before); ++i) {
+        threads.push_back(std::make_unique<core::HandlerThread>("StartAll" + std::to_string(i)));
+        raw_threads.push_back(threads.back().get());
+    }
+
+    // 两个线程接管预热线程，其余新建线程
+    EXPECT_EQ(core::HandlerThread::startAll(raw_threads), raw_threads.size());
+    EXPECT_EQ(core::HandlerThread::spareThreadCount(), 0u);
+
+    for (auto& thread : threads) {
+        // startAll 返回后 Looper 已就绪，getLooper() 不会阻塞
+        auto looper = thread->getLooper();
+        ASSERT_NE(looper, nullptr);
+        EXPECT_EQ(looper->getThreadId(), thread->getThreadId());
+
+        auto handler = std::make_shared<TestHandler>(looper);
+        auto future = handler->executed_thread_id_promise.get_future();
+        handler->sendMessage(handler->obtainMessage(1));
+        ASSERT_EQ(future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+        EXPECT_EQ(future.get(), thread->getThreadId());
+    }
+
+    for (auto& thread : threads) {
+        thread->quit();
+        thread->join();
+    }
+}
+
+// 测试9: NumaMemoryResource 绑定节点时按页分配，拒绝超过页大小的对齐
+// 目标: 覆盖节点绑定路径的对齐检查与分配/释放
+TEST(NumaMemoryResourceTest, RejectsAlignmentAbovePageSize) {
+    core::NumaMemoryResource resource(0);
+    void* p = resource.allocate(4096, alignof(std::max_align_t));
+    ASSERT_NE(p, nullptr);
+    static_cast<char*>(p)[0] = 1; // 触发实际的页面分配
+    resource.deallocate(p, 4096, alignof(std::max_align_t));
+
+    if (resource.node() >= 0) {
+        EXPECT_THROW((void)resource.allocate(4096, 1 << 20), std::bad_alloc);
+    }
+    // 绑定失败只会把节点退化为 -1，不会变成其他值
+    EXPECT_TRUE(resource.node() == 0 || resource.node() == -1);
+}
@@ -0,0 +1,364 @@
+#ifndef LIMITED_EXECUTORS_H
+#define LIMITED_EXECUTORS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace core {
+
+    /**
+     * @class RateLimitedExecutor
+     * @brief 令牌桶限速的执行器装饰器：把任务以不超过 permitsPerSecond 的速率交给目标执行器。
+     *
+     * 与 Throttler 不同，超出速率的任务不会被丢弃，而是按提交顺序排队，
+     * 并通过目标的 postDelayed()（即 Looper 的延时消息）在下一个令牌可用时再投递。
+     * 排队的任务在目标线程上执行。
+     *
+     * Executor 需要提供 bool post(std::function<void()>) 和
+     * bool postDelayed(std::function<void()>, long)，例如 WorkerThread 或 Handler；
+     * 它必须比本对象活得更久。
+     *
+     * <h2>使用示例</h2>
+     * @code
+     * core::WorkerThread network("Network");
+     * network.start();
+     * core::RateLimitedExecutor<core::WorkerThread> limited(network, 10.0, 5); // 10 次/秒，突发 5 次
+     *
+     * for (auto& request : requests) {
+     *     limited.post([request]() { send(request); });
+     * }
+     * std::cout << limited.metrics().maxQueueDepth << std::endl;
+     * @endcode
+     */
+    template <typename Executor>
+    class RateLimitedExecutor {
+    public:
+        struct Metrics {
+            size_t queueDepth = 0;      // 当前等待令牌的任务数
+            size_t maxQueueDepth = 0;   // 等待队列的历史最大长度
+            uint64_t submitted = 0;     // post() 调用次数
+            uint64_t forwarded = 0;     // 已交给目标执行器的任务数
+            uint64_t deferred = 0;      // 因没有令牌而排队的任务数
+            uint64_t rejected = 0;      // 目标执行器拒绝的任务数
+        };
+
+        /**
+         * @param target 目标执行器。
+         * @param permitsPerSecond 每秒补充的令牌数，必须大于 0。
+         * @param burst 令牌桶容量，即允许连续立即执行的任务数。初始时桶是满的。
+         */
+        RateLimitedExecutor(Executor& target, double permitsPerSecond, size_t burst = 1)
+            : mState(std::make_shared<State>(target, permitsPerSecond, burst)) {}
+
+        /**
+         * @brief 析构时仍在排队的任务会不经限速直接交给目标执行器，不会丢失。
+         */
+        ~RateLimitedExecutor() {
+            std::deque<std::function<void()>> pending;
+            {
+                std::lock_guard<std::mutex> lock(mState->mutex);
+                pending.swap(mState->pending);
+                mState->metrics.queueDepth = 0;
+            }
+            for (auto& task : pending) {
+                mState->target.post(std::move(task));
+            }
+        }
+
+        RateLimitedExecutor(const RateLimitedExecutor&) = delete;
+        RateLimitedExecutor& operator=(const RateLimitedExecutor&) = delete;
+
+        /**
+         * @brief 提交任务。有令牌且没有排队的任务时立即交给目标执行器，否则排队等待。
+         * @return 如果任务被接受（立即投递或排队），返回 true；目标执行器拒绝时返回 false。
+         */
+        bool post(std::function<void()> task) {
+            State& s = *mState;
+            std::unique_lock<std::mutex> lock(s.mutex);
+            s.metrics.submitted++;
+            s.refill(std::chrono::steady_clock::now());
+            if (s.pending.empty() && s.tokens >= 1.0) {
+                s.tokens -= 1.0;
+                lock.unlock();
+                bool ok = s.target.post(std::move(task));
+                lock.lock();
+                if (ok) {
+                    s.metrics.forwarded++;
+                }
+                else {
+                    s.tokens += 1.0;
+                    s.metrics.rejected++;
+                }
+                return ok;
+            }
+
+            s.pending.push_back(std::move(task));
+            s.metrics.deferred++;
+            s.metrics.queueDepth = s.pending.size();
+            s.metrics.maxQueueDepth = std::max(s.metrics.maxQueueDepth, s.metrics.queueDepth);
+            if (!s.drainScheduled && !scheduleDrainLocked(mState)) {
+                s.pending.pop_back();
+                s.metrics.deferred--;
+                s.metrics.queueDepth = s.pending.size();
+                s.metrics.rejected++;
+                return false;
+            }
+            return true;
+        }
+
+        Metrics metrics() const {
+            std::lock_guard<std::mutex> lock(mState->mutex);
+            return mState->metrics;
+        }
+
+        size_t queueDepth() const {
+            std::lock_guard<std::mutex> lock(mState->mutex);
+            return mState->pending.size();
+        }
+
+    private:
+        struct State {
+            State(Executor& t, double permitsPerSecond, size_t burstSize)
+                : target(t), rate(permitsPerSecond), burst(static_cast<double>(std::max<size_t>(1, burstSize))),
+                tokens(burst), lastRefill(std::chrono::steady_clock::now()) {}
+
+            void refill(std::chrono::steady_clock::time_point now) {
+                std::chrono::duration<double> elapsed = now - lastRefill;
+                tokens = std::min(burst, tokens + elapsed.count() * rate);
+                lastRefill = now;
+            }
+
+            Executor& target;
+            const double rate;
+            const double burst;
+            double tokens;
+            std::chrono::steady_clock::time_point lastRefill;
+
+            mutable std::mutex mutex;
+            std::deque<std::function<void()>> pending;
+            bool drainScheduled = false;
+            Metrics metrics;
+        };
+
+        // 在下一个令牌可用时通过延时消息唤醒 drain；调用时持有 state->mutex
+        static bool scheduleDrainLocked(const std::shared_ptr<State>& state) {
+            double missing = 1.0 - state->tokens;
+            long delayMillis = std::max(1L, static_cast<long>(std::ceil(missing / state->rate * 1000.0)));
+            std::weak_ptr<State> weak = state;
+            state->drainScheduled = state->target.postDelayed([weak]() { drain(weak); }, delayMillis);
+            return state->drainScheduled;
+        }
+
+        // 运行在目标线程上：取出令牌允许的任务并直接执行，保持提交顺序。
+        // 无法再安排下一次 drain 时，剩余的任务被丢弃
+        static void drain(const std::weak_ptr<State>& weak) {
+            std::shared_ptr<State> state = weak.lock();
+            if (!state) {
+                return;
+            }
+            std::vector<std::function<void()>> ready;
+            std::deque<std::function<void()>> dropped; // 在锁外析构
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->drainScheduled = false;
+                state->refill(std::chrono::steady_clock::now());
+                while (!state->pending.empty() && state->tokens >= 1.0) {
+                    state->tokens -= 1.0;
+                    ready.push_back(std::move(state->pending.front()));
+                    state->pending.pop_front();
+                }
+                state->metrics.forwarded += ready.size();
+                state->metrics.queueDepth = state->pending.size();
+                if (!state->pending.empty() && !scheduleDrainLocked(state)) {
+                    // 目标拒绝了延时消息（例如正在退出），之后不会再有 drain：丢弃剩余任务并计入 rejected
+                    state->metrics.rejected += state->pending.size();
+                    dropped.swap(state->pending);
+                    state->metrics.queueDepth = 0;
+                }
+            }
+            for (auto& task : ready) {
+                task();
+            }
+        }
+
+        std::shared_ptr<State> mState;
+    };
+
+    /**
+     * @class ConcurrencyLimitedExecutor
+     * @brief 限制同时在途任务数的执行器装饰器（非阻塞的计数信号量）。
+     *
+     * 最多 maxInFlight 个任务同时处于“已交给目标但尚未完成”的状态，其余任务按提交顺序排队，
+     * 在有任务完成时由完成方投递下一个。提交方永远不会被阻塞。
+     *
+     * post() 的任务在函数返回时即完成；postAsync() 的任务接收一个 done 回调，
+     * 在异步操作（例如一次网络请求）真正结束时调用，适合限制在途请求数。
+     *
+     * Executor 需要提供 bool post(std::function<void()>)，例如 WorkerThread、Handler 或 WorkerPool；
+     * 它必须比所有排队的任务活得更久。本对象析构后，已排队的任务仍会继续被投递。
+     * 目标接受了任务却没有执行就将其丢弃（例如 Looper 带着未处理的消息退出）时，许可随任务一起释放，
+     * 排队的任务继续投递；目标拒绝的任务计入 rejected。
+     */
+    template <typename Executor>
+    class ConcurrencyLimitedExecutor {
+    public:
+        using Done = std::function<void()>;
+        using AsyncTask = std::function<void(Done)>;
+
+        struct Metrics {
+            size_t inFlight = 0;        // 当前在途任务数
+            size_t maxInFlight = 0;     // 在途任务数的历史最大值
+            size_t queueDepth = 0;      // 当前等待许可的任务数
+            size_t maxQueueDepth = 0;   // 等待队列的历史最大长度
+            uint64_t submitted = 0;     // 提交次数
+            uint64_t completed = 0;     // 已完成的任务数
+            uint64_t rejected = 0;      // 目标执行器拒绝的任务数
+        };
+
+        ConcurrencyLimitedExecutor(Executor& target, size_t maxInFlight)
+            : mState(std::make_shared<State>(target, std::max<size_t>(1, maxInFlight))) {}
+
+        ConcurrencyLimitedExecutor(const ConcurrencyLimitedExecutor&) = delete;
+        ConcurrencyLimitedExecutor& operator=(const ConcurrencyLimitedExecutor&) = delete;
+
+        /**
+         * @brief 提交一个同步任务，任务返回（或抛出异常）即释放许可。
+         * @return 如果任务被接受，返回 true；目标执行器拒绝时返回 false。
+         */
+        bool post(std::function<void()> task) {
+            return postAsync([task = std::move(task)](Done done) {
+                try {
+                    task();
+                }
+                catch (...) {
+                    done();
+                    throw;
+                }
+                done();
+            });
+        }
+
+        /**
+         * @brief 提交一个异步任务。任务必须恰好调用一次 done（可以在任何线程上）来释放许可。
+         * @return 如果任务被接受，返回 true；目标执行器拒绝时返回 false。
+         */
+        bool postAsync(AsyncTask task) {
+            State& s = *mState;
+            std::unique_lock<std::mutex> lock(s.mutex);
+            s.metrics.submitted++;
+            if (s.pending.empty() && s.metrics.inFlight < s.limit) {
+                s.acquireLocked();
+                lock.unlock();
+                if (dispatch(mState, std::move(task))) {
+                    return true;
+                }
+                lock.lock();
+                s.metrics.inFlight--;
+                s.metrics.rejected++;
+                return false;
+            }
+            s.pending.push_back(std::move(task));
+            s.metrics.queueDepth = s.pending.size();
+            s.metrics.maxQueueDepth = std::max(s.metrics.maxQueueDepth, s.metrics.queueDepth);
+            return true;
+        }
+
+        Metrics metrics() const {
+            std::lock_guard<std::mutex> lock(mState->mutex);
+            return mState->metrics;
+        }
+
+        size_t queueDepth() const {
+            std::lock_guard<std::mutex> lock(mState->mutex);
+            return mState->pending.size();
+        }
+
+        size_t inFlight() const {
+            std::lock_guard<std::mutex> lock(mState->mutex);
+            return mState->metrics.inFlight;
+        }
+
+    private:
+        struct State {
+            State(Executor& t, size_t maxInFlight) : target(t), limit(maxInFlight) {}
+
+            void acquireLocked() {
+                metrics.inFlight++;
+                metrics.maxInFlight = std::max(metrics.maxInFlight, metrics.inFlight);
+            }
+
+            Executor& target;
+            const size_t limit;
+            mutable std::mutex mutex;
+            std::deque<AsyncTask> pending;
+            Metrics metrics;
+        };
+
+        // 一个许可：done 被调用时释放；若投递出去的任务或 done 回调没有执行就被销毁
+        // （例如目标 Looper 退出时丢弃了排队的消息），则在析构时释放，避免限流器被永久占满
+        class Permit {
+        public:
+            explicit Permit(std::shared_ptr<State> state) : mState(std::move(state)) {}
+            ~Permit() { release(); }
+
+            Permit(const Permit&) = delete;
+            Permit& operator=(const Permit&) = delete;
+
+            void release() {
+                if (!mReleased.exchange(true)) {
+                    ConcurrencyLimitedExecutor::release(mState);
+                }
+            }
+
+            // 投递被拒绝时由调用者自行归还许可
+            void disarm() { mReleased.store(true); }
+
+        private:
+            std::shared_ptr<State> mState;
+            std::atomic<bool> mReleased{ false };
+        };
+
+        static bool dispatch(const std::shared_ptr<State>& state, AsyncTask task) {
+            auto permit = std::make_shared<Permit>(state);
+            bool posted = state->target.post([permit, task = std::move(task)]() {
+                task([permit]() { permit->release(); });
+            });
+            if (!posted) {
+                permit->disarm();
+            }
+            return posted;
+        }
+
+        // 一个任务完成：把许可直接转交给队首任务，队列为空时归还许可
+        static void release(const std::shared_ptr<State>& state) {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->metrics.completed++;
+            while (!state->pending.empty()) {
+                AsyncTask next = std::move(state->pending.front());
+                state->pending.pop_front();
+                state->metrics.queueDepth = state->pending.size();
+                lock.unlock();
+                if (dispatch(state, std::move(next))) {
+                    return;
+                }
+                lock.lock();
+                state->metrics.rejected++;
+            }
+            state->metrics.inFlight--;
+        }
+
+        std::shared_ptr<State> mState;
+    };
+
+} // namespace core
+
+#endif // LIMITED_EXECUTORS_H
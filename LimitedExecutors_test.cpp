@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+#include "LimitedExecutors.h"
+#include "WorkerPool.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+// 测试令牌桶：突发之后的任务被延后而不是丢弃，并保持提交顺序
+TEST(RateLimitedExecutorTest, DefersTasksBeyondRate) {
+    core::WorkerThread worker("RateWorker");
+    worker.start();
+    core::RateLimitedExecutor<core::WorkerThread> limited(worker, 50.0, 2);
+
+    std::vector<int> order;
+    std::promise<void> done;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(limited.post([&order, &done, i]() {
+            order.push_back(i);
+            if (i == 9) done.set_value();
+        }));
+    }
+    auto metrics = limited.metrics();
+    EXPECT_EQ(metrics.submitted, 10u);
+    EXPECT_EQ(metrics.deferred, 8u);
+    EXPECT_EQ(metrics.maxQueueDepth, 8u);
+
+    ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    // 8 个被延后的任务在 50 次/秒下至少需要约 160ms
+    EXPECT_GE(elapsed, std::chrono::milliseconds(140));
+
+    ASSERT_EQ(order.size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+    metrics = limited.metrics();
+    EXPECT_EQ(metrics.forwarded, 10u);
+    EXPECT_EQ(metrics.queueDepth, 0u);
+}
+
+// 测试目标退出后无法再安排 drain 时，剩余排队的任务被丢弃并计入 rejected，而不是一直挂在队列里
+TEST(RateLimitedExecutorTest, DropsPendingWhenRescheduleIsRejected) {
+    core::WorkerThread worker("RateQuitWorker");
+    worker.start();
+    core::RateLimitedExecutor<core::WorkerThread> limited(worker, 20.0, 1);
+
+    // 第一个任务消耗唯一的令牌并阻塞目标线程
+    std::promise<void> blockerStarted;
+    std::promise<void> unblock;
+    auto unblocked = unblock.get_future().share();
+    ASSERT_TRUE(limited.post([&, unblocked]() {
+        blockerStarted.set_value();
+        unblocked.wait();
+    }));
+    blockerStarted.get_future().wait();
+
+    std::atomic<int> ran{ 0 };
+    ASSERT_TRUE(limited.post([&]() { ran++; }));
+    ASSERT_TRUE(limited.post([&]() { ran++; }));
+    EXPECT_EQ(limited.queueDepth(), 2u);
+
+    // 等到 drain 到期后再安全退出：到期的 drain 仍会执行，但它安排的下一次 drain 会被拒绝
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    worker.quitSafely();
+    unblock.set_value();
+    worker.join();
+
+    auto metrics = limited.metrics();
+    EXPECT_EQ(ran.load(), 1);
+    EXPECT_EQ(metrics.forwarded, 2u);
+    EXPECT_EQ(metrics.rejected, 1u);
+    EXPECT_EQ(metrics.queueDepth, 0u);
+    EXPECT_EQ(limited.queueDepth(), 0u);
+}
+
+// 测试在途任务数不超过上限，所有任务最终完成
+TEST(ConcurrencyLimitedExecutorTest, CapsTasksInFlight) {
+    core::WorkerPool pool(4, "LimitPool");
+    core::ConcurrencyLimitedExecutor<core::WorkerPool> limited(pool, 2);
+
+    std::atomic<int> running{ 0 };
+    std::atomic<int> maxRunning{ 0 };
+    std::atomic<int> finished{ 0 };
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(limited.post([&]() {
+            int now = ++running;
+            int seen = maxRunning.load();
+            while (now > seen && !maxRunning.compare_exchange_weak(seen, now)) {}
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            --running;
+            ++finished;
+        }));
+    }
+    EXPECT_GT(limited.queueDepth(), 0u);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (limited.metrics().completed < 20 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto metrics = limited.metrics();
+    EXPECT_EQ(finished.load(), 20);
+    EXPECT_EQ(metrics.completed, 20u);
+    EXPECT_EQ(metrics.inFlight, 0u);
+    EXPECT_EQ(metrics.maxInFlight, 2u);
+    EXPECT_LE(maxRunning.load(), 2);
+    EXPECT_GE(metrics.maxQueueDepth, 17u);
+}
+
+// 测试 postAsync：许可直到 done 被调用才释放
+TEST(ConcurrencyLimitedExecutorTest, AsyncTaskHoldsPermitUntilDone) {
+    core::WorkerThread worker("AsyncLimitWorker");
+    worker.start();
+    core::ConcurrencyLimitedExecutor<core::WorkerThread> limited(worker, 1);
+
+    std::promise<std::function<void()>> firstDone;
+    std::promise<void> secondStarted;
+    ASSERT_TRUE(limited.postAsync([&](std::function<void()> done) { firstDone.set_value(std::move(done)); }));
+    ASSERT_TRUE(limited.post([&]() { secondStarted.set_value(); }));
+
+    auto release = firstDone.get_future().get();
+    auto second = secondStarted.get_future();
+    // 第一个任务的函数已返回，但尚未调用 done，第二个任务仍在排队
+    EXPECT_EQ(second.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+    EXPECT_EQ(limited.inFlight(), 1u);
+    EXPECT_EQ(limited.queueDepth(), 1u);
+
+    std::thread([release]() { release(); }).join();
+    EXPECT_EQ(second.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+}
+
+// 测试目标带着已接受的任务退出时，许可随被丢弃的任务释放，排队的任务不会永远卡住
+TEST(ConcurrencyLimitedExecutorTest, ReleasesPermitWhenTargetDropsTask) {
+    core::WorkerThread worker("DropLimitWorker");
+    worker.start();
+    core::ConcurrencyLimitedExecutor<core::WorkerThread> limited(worker, 2);
+
+    std::promise<void> blockerStarted;
+    std::promise<void> unblock;
+    auto unblocked = unblock.get_future().share();
+    std::atomic<int> ran{ 0 };
+    ASSERT_TRUE(limited.post([&, unblocked]() {
+        blockerStarted.set_value();
+        unblocked.wait();
+    }));
+    blockerStarted.get_future().wait();
+    // 第二个任务已交给 Looper，排在阻塞任务之后；其余两个在限流器中等待许可
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(limited.post([&]() { ran++; }));
+    }
+    EXPECT_EQ(limited.inFlight(), 2u);
+    EXPECT_EQ(limited.queueDepth(), 2u);
+
+    // quit() 丢弃 Looper 中未处理的消息，排队的任务随后被投递并被拒绝
+    worker.quit();
+    EXPECT_EQ(limited.inFlight(), 1u);
+    EXPECT_EQ(limited.queueDepth(), 0u);
+    EXPECT_EQ(limited.metrics().rejected, 2u);
+
+    unblock.set_value();
+    worker.join();
+    EXPECT_EQ(ran.load(), 0);
+    EXPECT_EQ(limited.inFlight(), 0u);
+}
@@ -0,0 +1,155 @@
+#include "Numa.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <new>      // For std::bad_alloc
+
+#if defined(__linux__)
+#include <sched.h>        // sched_getcpu
+#include <sys/mman.h>     // mmap, munmap
+#include <sys/syscall.h>  // SYS_mbind, SYS_set_mempolicy
+#include <unistd.h>       // syscall, sysconf
+#endif
+
+namespace core {
+
+#if defined(__linux__)
+    // 与 <numaif.h> 中的定义一致，这里直接使用系统调用以避免依赖 libnuma
+    static constexpr int kMpolPreferred = 1;
+    static constexpr int kMpolBind = 2;
+    static constexpr unsigned long kMaxNodes = sizeof(unsigned long) * 8;
+
+    static std::string nodePath(int node) {
+        return "/sys/devices/system/node/node" + std::to_string(node);
+    }
+
+    // 解析形如 "0-3,8-11" 的 CPU 列表
+    static std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream ss(list);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            if (range.empty() || range == "\n") continue;
+            auto dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+#endif
+
+    int Numa::nodeCount() {
+#if defined(__linux__)
+        static const int count = []() {
+            int n = 0;
+            while (std::ifstream(nodePath(n) + "/cpulist").good()) {
+                ++n;
+            }
+            return n > 0 ? n : 1;
+        }();
+        return count;
+#else
+        return 1;
+#endif
+    }
+
+    int Numa::currentNode() {
+#if defined(__linux__)
+        unsigned cpu = 0;
+        unsigned node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+            return static_cast<int>(node);
+        }
+#endif
+        return -1;
+    }
+
+    std::vector<int> Numa::nodeCpus(int node) {
+#if defined(__linux__)
+        if (node < 0) return {};
+        std::ifstream in(nodePath(node) + "/cpulist");
+        std::string list;
+        if (in && std::getline(in, list)) {
+            return parseCpuList(list);
+        }
+#endif
+        return {};
+    }
+
+    bool Numa::setPreferredNode(int node) {
+#if defined(__linux__)
+        if (node < 0 || node >= nodeCount() || static_cast<unsigned long>(node) >= kMaxNodes) {
+            return false;
+        }
+        unsigned long mask = 1UL << node;
+        return syscall(SYS_set_mempolicy, kMpolPreferred, &mask, kMaxNodes) == 0;
+#else
+        return false;
+#endif
+    }
+
+    // --- NumaMemoryResource ---
+
+    NumaMemoryResource::NumaMemoryResource(int node) : mNode(-1) {
+#if defined(__linux__)
+        // 只有在节点有效且内核支持 mbind 时才使用节点绑定的分配路径
+        if (node >= 0 && node < Numa::nodeCount() && static_cast<unsigned long>(node) < kMaxNodes) {
+            long page = sysconf(_SC_PAGESIZE);
+            void* probe = mmap(nullptr, page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (probe != MAP_FAILED) {
+                unsigned long mask = 1UL << node;
+                if (syscall(SYS_mbind, probe, page, kMpolBind, &mask, kMaxNodes, 0) == 0) {
+                    mNode.store(node, std::memory_order_relaxed);
+                    mMapped = true;
+                }
+                munmap(probe, page);
+            }
+        }
+#endif
+    }
+
+    void* NumaMemoryResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+#if defined(__linux__)
+        if (mMapped) {
+            // mmap 返回页对齐的内存，无法满足更大的对齐要求
+            if (alignment > static_cast<std::size_t>(sysconf(_SC_PAGESIZE))) {
+                throw std::bad_alloc();
+            }
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            int node = mNode.load(std::memory_order_relaxed);
+            if (node >= 0) {
+                unsigned long mask = 1UL << node;
+                // 页面在首次写入时才真正分配，mbind 必须在此之前完成。
+                // 失败时这块内存按默认策略分配，不再声称绑定了节点
+                if (syscall(SYS_mbind, p, bytes, kMpolBind, &mask, kMaxNodes, 0) != 0) {
+                    mNode.store(-1, std::memory_order_relaxed);
+                }
+            }
+            return p;
+        }
+#endif
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void NumaMemoryResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+#if defined(__linux__)
+        if (mMapped) {
+            munmap(p, bytes);
+            return;
+        }
+#endif
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool NumaMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+} // namespace core
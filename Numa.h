@@ -0,0 +1,73 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource> // For std::pmr::memory_resource
+#include <vector>
+
+namespace core {
+
+    /**
+     * @class Numa
+     * @brief NUMA 拓扑查询与线程内存策略的轻量封装。
+     *
+     * 在 Linux 上直接读取 /sys/devices/system/node 并使用 set_mempolicy/mbind 系统调用，
+     * 不依赖 libnuma。在其他平台或未开启 NUMA 的内核上，所有函数退化为单节点行为：
+     * nodeCount() 返回 1，绑定操作返回 false。
+     */
+    class Numa {
+    public:
+        /**
+         * @brief 系统中 NUMA 节点的数量，无法获取时返回 1。
+         */
+        static int nodeCount();
+
+        /**
+         * @brief 当前线程正在运行的 CPU 所属的节点，无法获取时返回 -1。
+         */
+        static int currentNode();
+
+        /**
+         * @brief 属于指定节点的 CPU 编号列表，节点不存在时返回空列表。
+         */
+        static std::vector<int> nodeCpus(int node);
+
+        /**
+         * @brief 将当前线程的内存分配策略设为优先使用指定节点（MPOL_PREFERRED）。
+         * 之后该线程首次触及的页面都会从该节点分配。
+         * @return 成功返回 true；平台不支持或调用失败返回 false。
+         */
+        static bool setPreferredNode(int node);
+    };
+
+    /**
+     * @class NumaMemoryResource
+     * @brief 从指定 NUMA 节点分配内存的 std::pmr::memory_resource。
+     *
+     * 每次分配都通过 mmap 申请整页内存并用 mbind 绑定到目标节点，适合作为
+     * std::pmr::unsynchronized_pool_resource 等池化资源的上游，而不是直接用于小对象。
+     * 当 NUMA 不可用时退化为 std::pmr::new_delete_resource()。
+     * 某次 mbind 失败（例如 cpuset 限制导致 EPERM/ENOMEM）后，内存仍由 mmap 提供但不再绑定节点，
+     * node() 随之返回 -1。节点绑定路径不支持超过页大小的对齐，此时抛出 std::bad_alloc。
+     */
+    class NumaMemoryResource : public std::pmr::memory_resource {
+    public:
+        explicit NumaMemoryResource(int node);
+
+        // 实际生效的节点；退化为普通分配或绑定失败后返回 -1。可以在任意线程调用
+        int node() const { return mNode.load(std::memory_order_relaxed); }
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        std::atomic<int> mNode;
+        bool mMapped = false; // 分配走 mmap 路径；绑定失败后保持不变，以便正确释放
+    };
+
+} // namespace core
+
+#endif // NUMA_H
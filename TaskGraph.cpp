@@ -0,0 +1,161 @@
+#include "TaskGraph.h"
+#include <iostream>
+
+namespace core {
+
+TaskGraph::TaskGraph(WorkerPool& pool) : mPool(pool) {
+}
+
+TaskGraph::NodeId TaskGraph::addTask(std::string name, std::function<void()> task,
+    std::initializer_list<NodeId> dependencies) {
+    if (mRunning.load(std::memory_order_acquire)) {
+        // 工作线程正在读取 mNodes，扩容会使它们持有的引用失效
+        std::cerr << "Warning: TaskGraph::addTask called while the graph is running." << std::endl;
+        return kInvalidNode;
+    }
+    NodeId id = mNodes.size();
+    Node& node = mNodes.emplace_back();
+    node.task = std::move(task);
+    node.stats.name = std::move(name);
+    for (NodeId dependency : dependencies) {
+        addDependency(dependency, id);
+    }
+    mValidated = false;
+    return id;
+}
+
+bool TaskGraph::addDependency(NodeId before, NodeId after) {
+    if (before >= mNodes.size() || after >= mNodes.size() || before == after
+        || mRunning.load(std::memory_order_acquire)) {
+        return false;
+    }
+    mNodes[before].successors.push_back(after);
+    mNodes[after].inputCount++;
+    mValidated = false;
+    return true;
+}
+
+void TaskGraph::resetStats() {
+    for (Node& node : mNodes) {
+        std::string name = std::move(node.stats.name);
+        node.stats = NodeStats();
+        node.stats.name = std::move(name);
+    }
+}
+
+// Kahn 拓扑排序检查是否存在环；结构不变时只检查一次
+bool TaskGraph::validate() {
+    if (mValidated) {
+        return true;
+    }
+    std::vector<size_t> inputs(mNodes.size());
+    std::vector<NodeId> ready;
+    for (NodeId id = 0; id < mNodes.size(); ++id) {
+        inputs[id] = mNodes[id].inputCount;
+        if (inputs[id] == 0) {
+            ready.push_back(id);
+        }
+    }
+    size_t visited = 0;
+    while (!ready.empty()) {
+        NodeId id = ready.back();
+        ready.pop_back();
+        ++visited;
+        for (NodeId next : mNodes[id].successors) {
+            if (--inputs[next] == 0) {
+                ready.push_back(next);
+            }
+        }
+    }
+    mValidated = visited == mNodes.size();
+    return mValidated;
+}
+
+bool TaskGraph::run() {
+    bool expected = false;
+    if (!mRunning.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+        std::cerr << "Warning: TaskGraph::run called while the graph is already running." << std::endl;
+        return false;
+    }
+    if (!validate()) {
+        std::cerr << "Error: TaskGraph contains a dependency cycle." << std::endl;
+        mRunning.store(false, std::memory_order_release);
+        return false;
+    }
+
+    // 只重置计数器，不重新分配任何节点存储
+    for (Node& node : mNodes) {
+        node.pendingInputs.store(node.inputCount, std::memory_order_relaxed);
+    }
+    mFailed.store(false, std::memory_order_relaxed);
+    mError = nullptr;
+    mRemaining = mNodes.size();
+    mRunStart = std::chrono::steady_clock::now();
+
+    for (NodeId id = 0; id < mNodes.size(); ++id) {
+        if (mNodes[id].inputCount == 0) {
+            schedule(id);
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [this]() { return mRemaining == 0; });
+    }
+    mLastRunDuration = std::chrono::steady_clock::now() - mRunStart;
+    mRunning.store(false, std::memory_order_release);
+
+    if (mError) {
+        std::exception_ptr error = mError;
+        mError = nullptr;
+        std::rethrow_exception(error);
+    }
+    return true;
+}
+
+void TaskGraph::schedule(NodeId id) {
+    // 捕获 this 和 id，闭包足够小，std::function 不需要额外分配
+    if (!mPool.post([this, id]() { runNode(id); })) {
+        // 线程池正在退出，就地执行以保证 run() 能够返回
+        runNode(id);
+    }
+}
+
+void TaskGraph::runNode(NodeId id) {
+    Node& node = mNodes[id];
+    if (!mFailed.load(std::memory_order_acquire)) {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            node.task();
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!mError) {
+                mError = std::current_exception();
+            }
+            mFailed.store(true, std::memory_order_release);
+        }
+        auto duration = std::chrono::steady_clock::now() - start;
+        node.stats.runCount++;
+        node.stats.lastStartOffset = start - mRunStart;
+        node.stats.lastDuration = duration;
+        node.stats.totalDuration += duration;
+        if (duration > node.stats.maxDuration) {
+            node.stats.maxDuration = duration;
+        }
+    }
+
+    // 失败后仍然沿依赖传递完成信号，被跳过的节点也会计入完成数，run() 才能返回
+    for (NodeId next : node.successors) {
+        if (mNodes[next].pendingInputs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            schedule(next);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (--mRemaining == 0) {
+        mDone.notify_all();
+    }
+}
+
+} // namespace core
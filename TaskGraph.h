@@ -0,0 +1,134 @@
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include "WorkerPool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace core {
+
+/**
+ * @class TaskGraph
+ * @brief 有向无环的任务依赖图，由 WorkerPool 中的线程并行执行。
+ *
+ * 每个节点在其所有前驱完成后立即被投递到池中执行，互不依赖的节点并行运行。
+ * 图的结构建立一次后可以反复 run()：每次运行只重置节点上的计数器，
+ * 不会重新分配节点存储；节点函数通过引用读取调用者在两次运行之间更新的输入。
+ *
+ * <h2>使用示例</h2>
+ * @code
+ * core::WorkerPool pool(4);
+ * core::TaskGraph graph(pool);
+ *
+ * auto decode = graph.addTask("decode", [&]() { frame = decode(input); });
+ * auto stats  = graph.addTask("stats",  [&]() { histogram = computeStats(frame); }, { decode });
+ * auto scale  = graph.addTask("scale",  [&]() { thumb = scaleDown(frame); }, { decode });
+ * graph.addTask("store", [&]() { store(thumb, histogram); }, { stats, scale });
+ *
+ * for (auto& file : files) {
+ *     input = file;
+ *     graph.run();
+ * }
+ * std::cout << graph.stats(scale).totalDuration.count() << std::endl;
+ * @endcode
+ */
+class TaskGraph {
+public:
+    using NodeId = size_t;
+
+    // addTask() 在图运行期间被调用时返回的无效 id
+    static constexpr NodeId kInvalidNode = static_cast<NodeId>(-1);
+
+    // 单个节点的计时统计
+    struct NodeStats {
+        std::string name;
+        size_t runCount = 0;
+        // 本次运行中节点开始执行时相对于 run() 开始的偏移，可用于分析关键路径
+        std::chrono::nanoseconds lastStartOffset{ 0 };
+        std::chrono::nanoseconds lastDuration{ 0 };
+        std::chrono::nanoseconds totalDuration{ 0 };
+        std::chrono::nanoseconds maxDuration{ 0 };
+    };
+
+    /**
+     * @param pool 执行节点的线程池，必须比 TaskGraph 活得更久。
+     */
+    explicit TaskGraph(WorkerPool& pool);
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    /**
+     * @brief 添加一个节点。
+     * @param name 节点名称，用于统计输出。
+     * @param task 节点执行的任务。
+     * @param dependencies 必须在本节点之前完成的节点。
+     * @return 新节点的 id；图正在运行时不做任何修改并返回 kInvalidNode。
+     */
+    NodeId addTask(std::string name, std::function<void()> task, std::initializer_list<NodeId> dependencies = {});
+
+    /**
+     * @brief 声明 after 依赖于 before。
+     * @return 如果任一 id 无效、两者相同或正在运行，返回 false。
+     */
+    bool addDependency(NodeId before, NodeId after);
+
+    /**
+     * @brief 执行整个图并阻塞直到所有节点完成。
+     *
+     * 不要在 pool 的线程上调用，否则可能等待自己而死锁。
+     * 如果某个节点抛出异常，尚未开始的节点会被跳过，第一个异常在此重新抛出。
+     * @return 成功返回 true；图中存在环或图正在运行时返回 false。
+     */
+    bool run();
+
+    size_t size() const { return mNodes.size(); }
+
+    const NodeStats& stats(NodeId id) const { return mNodes[id].stats; }
+
+    // 上一次 run() 从开始到全部节点完成的耗时
+    std::chrono::nanoseconds lastRunDuration() const { return mLastRunDuration; }
+
+    // 清空所有节点的统计数据
+    void resetStats();
+
+private:
+    struct Node {
+        std::function<void()> task;
+        std::vector<NodeId> successors;
+        size_t inputCount = 0;
+        std::atomic<size_t> pendingInputs{ 0 };
+        NodeStats stats;
+    };
+
+    bool validate();
+    void schedule(NodeId id);
+    void runNode(NodeId id);
+
+    WorkerPool& mPool;
+    // std::deque 保证节点地址稳定（节点含原子成员，不可移动）
+    std::deque<Node> mNodes;
+    bool mValidated = false;
+    std::atomic<bool> mRunning{ false };
+
+    std::atomic<bool> mFailed{ false };
+    std::exception_ptr mError;
+    std::chrono::steady_clock::time_point mRunStart;
+    std::chrono::nanoseconds mLastRunDuration{ 0 };
+
+    std::mutex mMutex;
+    std::condition_variable mDone;
+    size_t mRemaining = 0;
+};
+
+} // namespace core
+
+#endif // TASK_GRAPH_H
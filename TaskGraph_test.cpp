@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include "TaskGraph.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+// 测试节点按依赖顺序执行，互不依赖的节点并行执行
+TEST(TaskGraphTest, RunsNodesAfterDependencies) {
+    core::WorkerPool pool(4, "GraphPool");
+    core::TaskGraph graph(pool);
+
+    std::atomic<int> clock{ 0 };
+    int order[4] = { -1, -1, -1, -1 };
+    std::atomic<int> concurrent{ 0 };
+    std::atomic<int> maxConcurrent{ 0 };
+    auto middle = [&](int slot) {
+        return [&, slot]() {
+            int now = ++concurrent;
+            int seen = maxConcurrent.load();
+            while (now > seen && !maxConcurrent.compare_exchange_weak(seen, now)) {}
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            order[slot] = clock++;
+            --concurrent;
+        };
+    };
+
+    auto a = graph.addTask("a", [&]() { order[0] = clock++; });
+    auto b = graph.addTask("b", middle(1), { a });
+    auto c = graph.addTask("c", middle(2), { a });
+    auto d = graph.addTask("d", [&]() { order[3] = clock++; }, { b, c });
+    ASSERT_EQ(graph.size(), 4u);
+
+    ASSERT_TRUE(graph.run());
+    EXPECT_EQ(order[0], 0);
+    EXPECT_LT(order[0], order[1]);
+    EXPECT_LT(order[0], order[2]);
+    EXPECT_EQ(order[3], 3);
+    EXPECT_EQ(maxConcurrent.load(), 2);
+
+    EXPECT_EQ(graph.stats(b).name, "b");
+    EXPECT_EQ(graph.stats(b).runCount, 1u);
+    EXPECT_GE(graph.stats(b).lastDuration, std::chrono::milliseconds(20));
+    EXPECT_GE(graph.stats(d).lastStartOffset, graph.stats(b).lastDuration);
+    EXPECT_GE(graph.lastRunDuration(), std::chrono::milliseconds(20));
+}
+
+// 测试同一个图可以用新的输入反复运行
+TEST(TaskGraphTest, RerunWithNewInputs) {
+    core::WorkerPool pool(2, "RerunPool");
+    core::TaskGraph graph(pool);
+
+    int input = 0;
+    int doubled = 0;
+    int result = 0;
+    auto source = graph.addTask("double", [&]() { doubled = input * 2; });
+    graph.addTask("plus one", [&]() { result = doubled + 1; }, { source });
+
+    for (int i = 1; i <= 50; ++i) {
+        input = i;
+        ASSERT_TRUE(graph.run());
+        EXPECT_EQ(result, i * 2 + 1);
+    }
+    EXPECT_EQ(graph.stats(source).runCount, 50u);
+
+    graph.resetStats();
+    EXPECT_EQ(graph.stats(source).runCount, 0u);
+    EXPECT_EQ(graph.stats(source).name, "double");
+}
+
+// 测试环被拒绝，节点异常会跳过下游节点并重新抛出
+TEST(TaskGraphTest, RejectsCyclesAndPropagatesExceptions) {
+    core::WorkerPool pool(2, "ErrorPool");
+
+    core::TaskGraph cyclic(pool);
+    auto x = cyclic.addTask("x", []() {});
+    auto y = cyclic.addTask("y", []() {}, { x });
+    EXPECT_FALSE(cyclic.addDependency(x, x));
+    EXPECT_TRUE(cyclic.addDependency(y, x));
+    EXPECT_FALSE(cyclic.run());
+
+    core::TaskGraph failing(pool);
+    bool downstreamRan = false;
+    auto bad = failing.addTask("bad", []() { throw std::runtime_error("stage failed"); });
+    failing.addTask("downstream", [&]() { downstreamRan = true; }, { bad });
+    EXPECT_THROW(failing.run(), std::runtime_error);
+    EXPECT_FALSE(downstreamRan);
+
+    // 失败之后图仍然可以再次运行
+    EXPECT_THROW(failing.run(), std::runtime_error);
+}
+
+// 测试运行期间修改图会被拒绝，图结构保持不变，运行结束后可以继续添加节点
+TEST(TaskGraphTest, RejectsChangesWhileRunning) {
+    core::WorkerPool pool(2, "BusyPool");
+    core::TaskGraph graph(pool);
+
+    core::TaskGraph::NodeId added = 0;
+    bool dependencyAdded = true;
+    auto first = graph.addTask("first", [&]() {
+        added = graph.addTask("late", []() {});
+        dependencyAdded = graph.addDependency(0, 1);
+    });
+    graph.addTask("second", []() {}, { first });
+    ASSERT_TRUE(graph.run());
+
+    EXPECT_EQ(added, core::TaskGraph::kInvalidNode);
+    EXPECT_FALSE(dependencyAdded);
+    EXPECT_EQ(graph.size(), 2u);
+
+    EXPECT_EQ(graph.addTask("third", []() {}), 2u);
+    EXPECT_TRUE(graph.run());
+}
@@ -0,0 +1,161 @@
+#include "WorkerPool.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+
+namespace core {
+
+WorkerPool::WorkerPool(size_t threadCount, const std::string& name) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<HandlerThread*> threads;
+    mWorkers.reserve(threadCount);
+    threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        mWorkers.push_back(std::make_unique<WorkerThread>(name + "-" + std::to_string(i)));
+        threads.push_back(mWorkers.back().get());
+    }
+    HandlerThread::startAll(threads);
+}
+
+WorkerPool::~WorkerPool() {
+    for (auto& worker : mWorkers) {
+        worker->finish();
+    }
+    for (auto& worker : mWorkers) {
+        worker->join();
+    }
+}
+
+bool WorkerPool::post(std::function<void()> task) {
+    size_t index = mNextWorker.fetch_add(1, std::memory_order_relaxed) % mWorkers.size();
+    return mWorkers[index]->post(std::move(task));
+}
+
+namespace {
+    // 一次 parallelFor 调用的共享状态，由调用者与所有辅助任务共同持有。
+    // 调用者只等待已经开始运行的辅助任务；排在忙碌线程队列里、晚于全部块被领取才开始的辅助任务
+    // 直接返回，既不计数也不会再触碰 ctx，因此调用者可以提前返回。
+    struct ChunkJob {
+        size_t begin;
+        size_t end;
+        size_t grain;
+        size_t chunkCount;
+        void* ctx;
+        void (*thunk)(void*, size_t, size_t);
+
+        std::atomic<size_t> nextChunk{ 0 };
+
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t runningHelpers = 0;
+        std::exception_ptr error;
+
+        bool allClaimed() const {
+            return nextChunk.load(std::memory_order_relaxed) >= chunkCount;
+        }
+
+        // 不断领取下一块执行，直到所有块都被领取
+        void drain() {
+            for (;;) {
+                size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= chunkCount) {
+                    return;
+                }
+                size_t first = begin + chunk * grain;
+                size_t last = std::min(end, first + grain);
+                try {
+                    thunk(ctx, first, last);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    // 让其他参与者尽快停止领取
+                    nextChunk.store(chunkCount, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+        void runHelper() {
+            {
+                // 先登记再领取：领取到块的辅助任务在完成之前一定被调用者看到
+                std::lock_guard<std::mutex> lock(mutex);
+                if (allClaimed()) {
+                    return;
+                }
+                ++runningHelpers;
+            }
+            drain();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--runningHelpers == 0) {
+                done.notify_all();
+            }
+        }
+    };
+}
+
+void WorkerPool::runChunks(size_t begin, size_t end, size_t grain, void* ctx, void (*thunk)(void*, size_t, size_t),
+    bool callerParticipates) {
+    if (end <= begin) {
+        return;
+    }
+    const size_t count = end - begin;
+    const std::thread::id self = std::this_thread::get_id();
+    size_t usableWorkers = 0;
+    for (auto& worker : mWorkers) {
+        if (worker->getThreadId() != self) {
+            ++usableWorkers;
+        }
+    }
+    // 在池内线程上调用时，其他工作线程可能正阻塞在各自的 parallelFor 中，
+    // 投递给它们的辅助任务不知何时才能开始，因此调用者总是参与领取
+    const bool onPoolThread = usableWorkers != mWorkers.size();
+    if (grain == 0) {
+        // 每个参与者大约分到 8 块，兼顾负载均衡与领取开销
+        size_t participants = usableWorkers + (callerParticipates ? 1 : 0);
+        grain = std::max<size_t>(1, count / (std::max<size_t>(1, participants) * 8));
+    }
+    // grain 可以很大（例如 SIZE_MAX 表示不切分），先限制到 count 以免 first + grain 溢出
+    grain = std::min(grain, count);
+
+    auto job = std::make_shared<ChunkJob>();
+    job->begin = begin;
+    job->end = end;
+    job->grain = grain;
+    job->chunkCount = count / grain + (count % grain != 0 ? 1 : 0);
+    job->ctx = ctx;
+    job->thunk = thunk;
+
+    // 调用者参与时它自己也会领取一块，因此只需 chunkCount - 1 个辅助任务
+    size_t helpers = std::min(usableWorkers, callerParticipates ? job->chunkCount - 1 : job->chunkCount);
+    size_t attempted = 0;
+    size_t posted = 0;
+    for (auto& worker : mWorkers) {
+        if (attempted == helpers) break;
+        if (worker->getThreadId() == self) continue;
+        ++attempted;
+        if (worker->post([job]() { job->runHelper(); })) {
+            ++posted;
+        }
+    }
+
+    // 没有成功投递任何辅助任务时（例如在单线程池的池内线程上调用），所有块由调用者完成
+    if (callerParticipates || onPoolThread || posted == 0) {
+        job->drain();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->done.wait(lock, [&job]() { return job->allClaimed() && job->runningHelpers == 0; });
+    }
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+} // namespace core
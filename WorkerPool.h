@@ -0,0 +1,141 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "WorkerThread.h"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace core {
+
+/**
+ * @class WorkerPool
+ * @brief 一组 WorkerThread，提供轮询提交以及 fork-join 形式的 parallelFor / parallelReduce。
+ *
+ * parallelFor 把区间 [begin, end) 切成大小为 grain 的块，所有参与线程通过一个原子计数器
+ * 动态领取下一块，因此块耗时不均时负载仍然均衡。默认调用线程也参与执行，
+ * 既能多用一个核心，也避免了在池内线程上调用时等待自己而死锁。
+ *
+ * <h2>使用示例</h2>
+ * @code
+ * core::WorkerPool pool(4, "Transform");
+ *
+ * pool.parallelFor(0, pixels.size(), 4096, [&](size_t i) {
+ *     pixels[i] = gamma(pixels[i]);
+ * });
+ *
+ * double sum = pool.parallelReduce(0, samples.size(), 0, 0.0,
+ *     [&](size_t first, size_t last) {
+ *         return std::accumulate(samples.begin() + first, samples.begin() + last, 0.0);
+ *     },
+ *     std::plus<double>());
+ * @endcode
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief 创建并启动 threadCount 个工作线程。
+     * @param threadCount 线程数量；为 0 时使用 std::thread::hardware_concurrency()。
+     * @param name 线程名前缀，各线程命名为 "<name>-<序号>"。
+     */
+    explicit WorkerPool(size_t threadCount = 0, const std::string& name = "WorkerPool");
+
+    /**
+     * @brief 等待所有已提交的任务执行完毕后停止并回收线程。
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t size() const { return mWorkers.size(); }
+
+    WorkerThread& worker(size_t index) { return *mWorkers[index]; }
+
+    /**
+     * @brief 以轮询方式把任务提交给下一个工作线程。
+     * @return 如果任务成功提交，返回 true。
+     */
+    bool post(std::function<void()> task);
+
+    /**
+     * @brief 在池中并行执行 fn，阻塞直到全部完成。
+     *
+     * fn 既可以接受单个下标 fn(size_t i)，也可以接受整块 fn(size_t first, size_t last)；
+     * 后者适合需要在块内做向量化或复用局部状态的场景。
+     * 任一块抛出异常时，尚未领取的块不再执行，第一个异常在调用线程上重新抛出。
+     * @param begin, end 下标区间 [begin, end)。
+     * @param grain 每块的下标数量；为 0 时按参与线程数自动选择。
+     * @param fn 要执行的函数。
+     * @param callerParticipates 调用线程是否也领取块执行。为 false 时调用线程只等待；
+     *        在池内线程上调用时，调用线程所在的工作线程不会被分配任务，且调用线程总会参与领取，
+     *        只等待已经开始运行的辅助任务，因此嵌套调用不会死锁。
+     */
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F&& fn, bool callerParticipates = true);
+
+    /**
+     * @brief 并行归约：每块调用 chunk(first, last) 得到部分结果，再用 combine 合并。
+     *
+     * 各部分结果的合并顺序不确定，combine 应满足结合律与交换律。
+     * @param identity 归约的初始值（combine 的单位元）。
+     * @return 归约结果；区间为空时返回 identity。
+     */
+    template <typename T, typename ChunkFn, typename Combine>
+    T parallelReduce(size_t begin, size_t end, size_t grain, T identity, ChunkFn&& chunk, Combine&& combine,
+        bool callerParticipates = true);
+
+private:
+    // 与类型无关的 fork-join 实现，fn 通过 (ctx, thunk) 传入，避免为每次调用分配 std::function
+    void runChunks(size_t begin, size_t end, size_t grain, void* ctx, void (*thunk)(void*, size_t, size_t),
+        bool callerParticipates);
+
+    std::vector<std::unique_ptr<WorkerThread>> mWorkers;
+    std::atomic<size_t> mNextWorker{ 0 };
+};
+
+template <typename F>
+void WorkerPool::parallelFor(size_t begin, size_t end, size_t grain, F&& fn, bool callerParticipates) {
+    using Fn = std::remove_reference_t<F>;
+    auto thunk = [](void* ctx, size_t first, size_t last) {
+        Fn& f = *static_cast<Fn*>(ctx);
+        if constexpr (std::is_invocable_v<Fn&, size_t, size_t>) {
+            f(first, last);
+        }
+        else {
+            for (size_t i = first; i < last; ++i) {
+                f(i);
+            }
+        }
+    };
+    runChunks(begin, end, grain, const_cast<void*>(static_cast<const void*>(std::addressof(fn))), thunk,
+        callerParticipates);
+}
+
+template <typename T, typename ChunkFn, typename Combine>
+T WorkerPool::parallelReduce(size_t begin, size_t end, size_t grain, T identity, ChunkFn&& chunk, Combine&& combine,
+    bool callerParticipates) {
+    struct Context {
+        std::remove_reference_t<ChunkFn>& chunk;
+        std::remove_reference_t<Combine>& combine;
+        std::mutex mutex;
+        T result;
+    } context{ chunk, combine, {}, std::move(identity) };
+
+    runChunks(begin, end, grain, &context, [](void* ctx, size_t first, size_t last) {
+        Context& c = *static_cast<Context*>(ctx);
+        T partial = c.chunk(first, last);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        c.result = c.combine(std::move(c.result), std::move(partial));
+    }, callerParticipates);
+    return std::move(context.result);
+}
+
+} // namespace core
+
+#endif // WORKER_POOL_H
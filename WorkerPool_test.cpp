@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+#include "WorkerPool.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// 测试 parallelFor 恰好访问每个下标一次，并且确实使用了多个线程
+TEST(WorkerPoolTest, ParallelForVisitsEveryIndexOnce) {
+    core::WorkerPool pool(4, "ForPool");
+    ASSERT_EQ(pool.size(), 4u);
+
+    const size_t n = 100000;
+    std::vector<std::atomic<int>> hits(n);
+    std::mutex threadsMutex;
+    std::set<std::thread::id> threads;
+
+    pool.parallelFor(0, n, 1000, [&](size_t first, size_t last) {
+        {
+            std::lock_guard<std::mutex> lock(threadsMutex);
+            threads.insert(std::this_thread::get_id());
+        }
+        for (size_t i = first; i < last; ++i) {
+            hits[i]++;
+        }
+        // 让块有一定耗时，确保工作线程有机会领取
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    });
+
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(hits[i].load(), 1) << "index " << i;
+    }
+    EXPECT_GT(threads.size(), 1u);
+
+    // 单下标形式、自动 grain、调用线程不参与
+    std::vector<int> squares(1000);
+    pool.parallelFor(0, squares.size(), 0, [&](size_t i) { squares[i] = static_cast<int>(i * i); }, false);
+    for (size_t i = 0; i < squares.size(); ++i) {
+        EXPECT_EQ(squares[i], static_cast<int>(i * i));
+    }
+
+    // 空区间直接返回
+    pool.parallelFor(5, 5, 1, [](size_t) { FAIL(); });
+}
+
+// 测试 parallelReduce 的结果与串行求和一致
+TEST(WorkerPoolTest, ParallelReduceMatchesSerial) {
+    core::WorkerPool pool(3, "ReducePool");
+    std::vector<long long> values(123457);
+    std::iota(values.begin(), values.end(), 1);
+
+    long long sum = pool.parallelReduce(0, values.size(), 1000, 0LL,
+        [&](size_t first, size_t last) {
+            return std::accumulate(values.begin() + first, values.begin() + last, 0LL);
+        },
+        std::plus<long long>());
+    EXPECT_EQ(sum, std::accumulate(values.begin(), values.end(), 0LL));
+
+    EXPECT_EQ(pool.parallelReduce(0, 0, 1, 7, [](size_t, size_t) { return 1; }, std::plus<int>()), 7);
+}
+
+// 测试 grain 大于区间长度（包括 SIZE_MAX）时整个区间作为一块执行
+TEST(WorkerPoolTest, HugeGrainRunsWholeRangeAsOneChunk) {
+    core::WorkerPool pool(2, "GrainPool");
+    std::atomic<int> chunks{ 0 };
+    std::atomic<size_t> visited{ 0 };
+    pool.parallelFor(10, 110, SIZE_MAX, [&](size_t first, size_t last) {
+        EXPECT_EQ(first, 10u);
+        EXPECT_EQ(last, 110u);
+        chunks++;
+        visited += last - first;
+    });
+    EXPECT_EQ(chunks.load(), 1);
+    EXPECT_EQ(visited.load(), 100u);
+}
+
+// 测试块中的异常在调用线程上重新抛出
+TEST(WorkerPoolTest, ParallelForRethrowsFirstException) {
+    core::WorkerPool pool(2, "ThrowPool");
+    EXPECT_THROW(pool.parallelFor(0, 1000, 10, [](size_t i) {
+        if (i == 500) throw std::runtime_error("bad index");
+    }), std::runtime_error);
+
+    // 池在异常之后仍然可用
+    std::atomic<int> count{ 0 };
+    pool.parallelFor(0, 100, 10, [&](size_t) { count++; });
+    EXPECT_EQ(count.load(), 100);
+}
+
+// 测试在池内线程上调用 parallelFor 不会死锁（包括不参与模式）
+TEST(WorkerPoolTest, NestedCallFromWorkerDoesNotDeadlock) {
+    core::WorkerPool pool(1, "NestedPool");
+    std::promise<int> result;
+    ASSERT_TRUE(pool.post([&]() {
+        std::atomic<int> count{ 0 };
+        pool.parallelFor(0, 64, 4, [&](size_t) { count++; }, false);
+        result.set_value(count.load());
+    }));
+    auto future = result.get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_EQ(future.get(), 64);
+}
+
+// 测试多线程池中外层 parallelFor 的每一块都嵌套 parallelFor 时不会死锁
+TEST(WorkerPoolTest, NestedParallelForOnMultiThreadPool) {
+    core::WorkerPool pool(4, "NestedMulti");
+    std::promise<long> result;
+    std::thread caller([&]() {
+        std::atomic<long> count{ 0 };
+        pool.parallelFor(0, 64, 1, [&](size_t) {
+            pool.parallelFor(0, 64, 1, [&](size_t) { count++; });
+        });
+        // 池内线程上以不参与模式嵌套调用同样不会等待排队中的辅助任务
+        pool.parallelFor(0, 16, 1, [&](size_t) {
+            pool.parallelFor(0, 16, 1, [&](size_t) { count++; }, false);
+        }, false);
+        result.set_value(count.load());
+    });
+    auto future = result.get_future();
+    bool ready = future.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+    if (!ready) {
+        caller.detach();
+        FAIL() << "nested parallelFor deadlocked";
+    }
+    caller.join();
+    EXPECT_EQ(future.get(), 64 * 64 + 16 * 16);
+}
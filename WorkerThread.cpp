@@ -20,9 +20,13 @@ WorkerThread::WorkerThread(const std::string& name)
     : HandlerThread(name), mWorkerHandler(nullptr) {
 }
 
+WorkerThread::WorkerThread(Options options)
+    : HandlerThread(std::move(options)), mWorkerHandler(nullptr) {
+}
+
 WorkerThread::~WorkerThread() {
-    // 确保线程被正确清理
-    if (mWorkerHandler) {
+    // 确保线程被正确清理。waitUntilReady() 保证 onLooperPrepared() 不会与析构并发执行
+    if (waitUntilReady()) {
         finish();
     }
     else {
@@ -32,19 +36,14 @@ WorkerThread::~WorkerThread() {
 }
 
 
-void WorkerThread::start() {
-    HandlerThread::start(); // 启动基类的线程和 Looper
-    // Looper 准备好后，创建我们的 WorkerHandler
-    std::shared_ptr<Looper> looper = getLooper();
-    if (looper) {
-        mWorkerHandler = std::make_shared<WorkerHandler>(looper);
-    } else {
-        std::cerr << "Failed to start WorkerThread: Looper is null." << std::endl;
-    }
+void WorkerThread::onLooperPrepared() {
+    // 运行在工作线程上，Looper 刚刚准备好，尚未发布给其他线程
+    mWorkerHandler = std::make_shared<WorkerHandler>(Looper::myLooper());
 }
 
 bool WorkerThread::post(std::function<void()> task) {
-    if (!mWorkerHandler) {
+    // Looper 发布后这里只是一次原子读取；mWorkerHandler 在发布之前就已写入
+    if (!waitUntilReady()) {
         return false;
     }
     // 使用 Handler 的 post 方法提交一个 runnable
@@ -52,7 +51,7 @@ bool WorkerThread::post(std::function<void()> task) {
 }
 
 bool WorkerThread::postDelayed(std::function<void()> task, long delayMillis) {
-    if (!mWorkerHandler) {
+    if (!waitUntilReady()) {
         return false;
     }
     // 使用 Handler 的 postDelayed 方法提交一个带延迟的 runnable
@@ -60,7 +59,7 @@ bool WorkerThread::postDelayed(std::function<void()> task, long delayMillis) {
 }
 
 bool WorkerThread::finish() {
-    if (!mWorkerHandler) {
+    if (!waitUntilReady()) {
         return false;
     }
 
@@ -72,7 +71,7 @@ bool WorkerThread::finish() {
 }
  
 bool WorkerThread::finishNow() {
-    if (!mWorkerHandler) {
+    if (!waitUntilReady()) {
         return false;
     }
     
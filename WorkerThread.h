@@ -2,8 +2,11 @@
 #define WORKER_THREAD_H
 
 #include "HandlerThread.h"
+#include "Future.h"
 #include <functional>
 #include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace core {
 
@@ -46,16 +49,15 @@ public:
     explicit WorkerThread(const std::string& name = "WorkerThread");
 
     /**
-     * @brief 析构函数。
+     * @brief 使用线程选项构造（线程名、CPU 亲和性、调度策略等）。
+     * @param options 参见 HandlerThread::Options。
      */
-    ~WorkerThread() override;
+    explicit WorkerThread(Options options);
 
     /**
-     * @brief 启动工作线程。
-     *
-     * 在调用任何 post 方法之前必须先调用此方法。
+     * @brief 析构函数。
      */
-    void start();
+    ~WorkerThread() override;
 
     /**
      * @brief 提交一个任务到工作线程立即执行。
@@ -72,6 +74,27 @@ public:
      */
     bool postDelayed(std::function<void()> task, long delayMillis);
 
+    /**
+     * @brief 批量提交任务：所有任务在一次加锁、一次唤醒内入队，并按范围中的顺序执行。
+     *
+     * 传入右值范围时任务会被移走，否则会被复制。
+     * @param tasks 任意可迭代的范围，元素可转换为 std::function<void()>。
+     * @return 被接受的任务数量；线程未启动或正在退出时为 0。
+     */
+    template <typename Range>
+    size_t postBatch(Range&& tasks);
+
+    /**
+     * @brief 提交一个带返回值的任务，返回可用 then() 串联的 core::Future。
+     *
+     * 任务与结果共享一次分配。任务抛出的异常由 Future::get() 重新抛出；
+     * 如果任务未能执行（线程未启动、正在退出或任务被丢弃），Future 收到 broken_promise。
+     * @param fn 无参数的可调用对象。
+     * @return 任务结果的 Future。
+     */
+    template <typename F>
+    auto submit(F&& fn) -> Future<std::invoke_result_t<std::decay_t<F>&>>;
+
     /**
      * @brief 完成并优雅地停止工作线程。
      *
@@ -90,6 +113,14 @@ public:
      * @return 如果停止消息成功发送，返回 true。
      */
     bool finishNow();
+
+protected:
+    /**
+     * @brief 在工作线程上创建内部 Handler，随后 Looper 才会被发布。
+     *
+     * 因此 start() 无需等待线程启动；post 系列方法在首次调用时才会等待 Looper 就绪。
+     */
+    void onLooperPrepared() override;
         
 private:
     // 一个简单的内部 Handler，仅用于处理 std::function<void()> 任务
@@ -102,6 +133,37 @@ private:
     std::shared_ptr<WorkerHandler> mWorkerHandler;
 };
 
+template <typename Range>
+size_t WorkerThread::postBatch(Range&& tasks) {
+    if (!waitUntilReady()) {
+        return 0;
+    }
+    std::vector<Message> messages;
+    if constexpr (requires { std::size(tasks); }) {
+        messages.reserve(std::size(tasks));
+    }
+    for (auto&& task : tasks) {
+        if constexpr (std::is_lvalue_reference_v<Range>) {
+            messages.emplace_back(std::function<void()>(task));
+        }
+        else {
+            messages.emplace_back(std::function<void()>(std::move(task)));
+        }
+    }
+    return mWorkerHandler->sendMessages(messages);
+}
+
+template <typename F>
+auto WorkerThread::submit(F&& fn) -> Future<std::invoke_result_t<std::decay_t<F>&>> {
+    using R = std::invoke_result_t<std::decay_t<F>&>;
+    using State = FutureTaskState<R, std::decay_t<F>>;
+    auto state = std::make_shared<State>(std::forward<F>(fn));
+    Future<R> future(state);
+    // 投递失败时 runner 随之销毁，future 会收到 broken_promise
+    post(FutureStateRunner<State>(std::move(state)));
+    return future;
+}
+
 } // namespace core
 
 #endif // WORKER_THREAD_H
\ No newline at end of file
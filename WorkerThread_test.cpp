@@ -172,4 +172,94 @@ TEST_F(WorkerThreadTest, FinishNowSkipsQueuedTasks) {
 
     // 6. 验证只有第一个任务被执行了
     EXPECT_EQ(task_execution_count, 1);
-}
\ No newline at end of file
+}
+
+// 测试 start() 不等待线程启动：立即 post 的任务仍会被执行
+// 目标: 覆盖 start() 之后首次 post 时才等待 Looper 就绪的路径
+TEST_F(WorkerThreadTest, PostImmediatelyAfterStart) {
+    std::promise<std::thread::id> executedThreadIdPromise;
+    auto executedThreadIdFuture = executedThreadIdPromise.get_future();
+
+    workerThread->start();
+    ASSERT_TRUE(workerThread->post([&]() {
+        executedThreadIdPromise.set_value(std::this_thread::get_id());
+    }));
+
+    ASSERT_EQ(executedThreadIdFuture.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_EQ(executedThreadIdFuture.get(), workerThread->getThreadId());
+}
+
+// 测试 postBatch 一次提交多个任务并按顺序执行
+// 目标: 覆盖 postBatch()
+TEST_F(WorkerThreadTest, PostBatchRunsTasksInOrder) {
+    std::vector<int> order;
+    std::vector<std::function<void()>> tasks;
+    for (int i = 0; i < 1000; ++i) {
+        tasks.push_back([&order, i]() { order.push_back(i); });
+    }
+
+    // 启动前提交会失败
+    EXPECT_EQ(workerThread->postBatch(tasks), 0u);
+
+    workerThread->start();
+    EXPECT_EQ(workerThread->postBatch(std::move(tasks)), 1000u);
+
+    std::promise<void> done;
+    workerThread->post([&]() { done.set_value(); });
+    ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(2)), std::future_status::ready);
+
+    ASSERT_EQ(order.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+// 测试 submit 返回 Future，并用 then() 把结果串联到另一个 WorkerThread
+// 目标: 覆盖 submit()、Future::then(executor, fn) 和 Future::get()
+TEST_F(WorkerThreadTest, SubmitChainsThenOnChosenLooper) {
+    core::WorkerThread other("OtherWorker");
+    workerThread->start();
+    other.start();
+
+    std::thread::id continuationThread;
+    auto result = workerThread->submit([]() { return 20; })
+        .then(other, [&](int value) {
+            continuationThread = std::this_thread::get_id();
+            return value + 1;
+        })
+        .then([](int value) { return std::to_string(value * 2); });
+
+    ASSERT_TRUE(result.waitFor(std::chrono::seconds(2)));
+    EXPECT_EQ(result.get(), "42");
+    EXPECT_FALSE(result.valid());
+    EXPECT_EQ(continuationThread, other.getThreadId());
+
+    // void 任务与 void 延续
+    std::atomic<int> counter{ 0 };
+    auto done = workerThread->submit([&]() { counter++; })
+        .then(*workerThread, [&]() { counter++; });
+    done.get();
+    EXPECT_EQ(counter.load(), 2);
+}
+
+// 测试任务异常跳过后续延续并由 get() 重新抛出；未能执行的任务得到 broken_promise
+// 目标: 覆盖 Future 的异常传播与 broken_promise 路径
+TEST_F(WorkerThreadTest, SubmitPropagatesExceptionsAndBrokenPromise) {
+    // 启动前提交：任务无法投递
+    auto rejected = workerThread->submit([]() { return 1; });
+    ASSERT_TRUE(rejected.isReady());
+    try {
+        rejected.get();
+        FAIL() << "expected broken_promise";
+    }
+    catch (const std::future_error& e) {
+        EXPECT_EQ(e.code(), std::make_error_code(std::future_errc::broken_promise));
+    }
+
+    workerThread->start();
+    bool continuationCalled = false;
+    auto failed = workerThread->submit([]() -> int { throw std::runtime_error("boom"); })
+        .then([&](int value) { continuationCalled = true; return value; });
+    EXPECT_THROW(failed.get(), std::runtime_error);
+    EXPECT_FALSE(continuationCalled);
+}
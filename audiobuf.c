@@ -25,6 +25,7 @@ audiobuf_init(struct audiobuf *buf, size_t sample_size,
     // The actual capacity is (alloc_size - 1) so that head == tail is
     // non-ambiguous
     buf->alloc_size = capacity + 1;
+    buf->mask = 0;
     buf->data = sc_allocarray(buf->alloc_size, sample_size);
     if (!buf->data) {
         //LOG_OOM();
@@ -34,6 +35,35 @@ audiobuf_init(struct audiobuf *buf, size_t sample_size,
     buf->sample_size = sample_size;
     atomic_init(&buf->head, 0);
     atomic_init(&buf->tail, 0);
+    futex_event_init(&buf->notify);
+
+    return true;
+}
+
+bool
+audiobuf_init_pow2(struct audiobuf *buf, size_t sample_size,
+                   uint32_t min_capacity) {
+    assert(sample_size);
+    assert(min_capacity && min_capacity <= (UINT32_C(1) << 31));
+
+    // At least 2, mask == 0 means non-pow2 mode
+    uint32_t size = 2;
+    while (size < min_capacity) {
+        size <<= 1;
+    }
+
+    // Free-running cursors tell full from empty, so all slots are usable
+    buf->alloc_size = size;
+    buf->mask = size - 1;
+    buf->data = sc_allocarray(buf->alloc_size, sample_size);
+    if (!buf->data) {
+        return false;
+    }
+
+    buf->sample_size = sample_size;
+    atomic_init(&buf->head, 0);
+    atomic_init(&buf->tail, 0);
+    futex_event_init(&buf->notify);
 
     return true;
 }
@@ -43,6 +73,32 @@ audiobuf_destroy(struct audiobuf *buf) {
     free(buf->data);
 }
 
+// Cursor helpers: in pow2 mode the cursors run freely and are masked on
+// access, otherwise they stay in [0, alloc_size)
+
+static inline uint32_t
+audiobuf_slot(struct audiobuf *buf, uint32_t cursor) {
+    return buf->mask ? cursor & buf->mask : cursor;
+}
+
+static inline uint32_t
+audiobuf_advance(struct audiobuf *buf, uint32_t cursor, uint32_t samples) {
+    return buf->mask ? cursor + samples
+                     : (cursor + samples) % buf->alloc_size;
+}
+
+static inline uint32_t
+audiobuf_used(struct audiobuf *buf, uint32_t head, uint32_t tail) {
+    return buf->mask ? head - tail
+                     : (buf->alloc_size + head - tail) % buf->alloc_size;
+}
+
+static inline uint32_t
+audiobuf_free(struct audiobuf *buf, uint32_t head, uint32_t tail) {
+    return buf->mask ? buf->alloc_size - (head - tail)
+                     : (buf->alloc_size + tail - head - 1) % buf->alloc_size;
+}
+
 uint32_t
 audiobuf_read(struct audiobuf *buf, void *to_, uint32_t samples_count) {
     assert(samples_count);
@@ -56,7 +112,7 @@ audiobuf_read(struct audiobuf *buf, void *to_, uint32_t samples_count) {
     // The head cursor is updated after the data is written to the array
     uint32_t head = atomic_load_explicit(&buf->head, memory_order_acquire);
 
-    uint32_t can_read = (buf->alloc_size + head - tail) % buf->alloc_size;
+    uint32_t can_read = audiobuf_used(buf, head, tail);
     if (!can_read) {
         return 0;
     }
@@ -65,12 +121,13 @@ audiobuf_read(struct audiobuf *buf, void *to_, uint32_t samples_count) {
     }
 
     if (to) {
-        uint32_t right_count = buf->alloc_size - tail;
+        uint32_t slot = audiobuf_slot(buf, tail);
+        uint32_t right_count = buf->alloc_size - slot;
         if (right_count > samples_count) {
             right_count = samples_count;
         }
         memcpy(to,
-               buf->data + (tail * buf->sample_size),
+               buf->data + (slot * buf->sample_size),
                right_count * buf->sample_size);
 
         if (samples_count > right_count) {
@@ -81,12 +138,47 @@ audiobuf_read(struct audiobuf *buf, void *to_, uint32_t samples_count) {
         }
     }
 
-    uint32_t new_tail = (tail + samples_count) % buf->alloc_size;
+    uint32_t new_tail = audiobuf_advance(buf, tail, samples_count);
     atomic_store_explicit(&buf->tail, new_tail, memory_order_release);
 
     return samples_count;
 }
 
+uint32_t
+audiobuf_acquire_read(struct audiobuf *buf, uint32_t max_samples,
+                      struct audiobuf_span spans[2]) {
+    uint32_t tail = atomic_load_explicit(&buf->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&buf->head, memory_order_acquire);
+
+    uint32_t count = audiobuf_used(buf, head, tail);
+    if (count > max_samples) {
+        count = max_samples;
+    }
+
+    uint32_t slot = audiobuf_slot(buf, tail);
+    uint32_t right_count = buf->alloc_size - slot;
+    if (right_count > count) {
+        right_count = count;
+    }
+    spans[0].data = buf->data + (slot * buf->sample_size);
+    spans[0].samples = right_count;
+    spans[1].data = buf->data;
+    spans[1].samples = count - right_count;
+
+    return count;
+}
+
+void
+audiobuf_commit_read(struct audiobuf *buf, uint32_t samples_count) {
+    uint32_t tail = atomic_load_explicit(&buf->tail, memory_order_relaxed);
+    assert(samples_count <= audiobuf_used(buf,
+               atomic_load_explicit(&buf->head, memory_order_acquire), tail));
+
+    // Publish the whole batch with a single store
+    uint32_t new_tail = audiobuf_advance(buf, tail, samples_count);
+    atomic_store_explicit(&buf->tail, new_tail, memory_order_release);
+}
+
 uint32_t
 audiobuf_write(struct audiobuf *buf, const void *from_,
                   uint32_t samples_count) {
@@ -99,7 +191,7 @@ audiobuf_write(struct audiobuf *buf, const void *from_,
     // The tail cursor is updated after the data is consumed by the reader
     uint32_t tail = atomic_load_explicit(&buf->tail, memory_order_acquire);
 
-    uint32_t can_write = (buf->alloc_size + tail - head - 1) % buf->alloc_size;
+    uint32_t can_write = audiobuf_free(buf, head, tail);
     if (!can_write) {
         return 0;
     }
@@ -107,11 +199,12 @@ audiobuf_write(struct audiobuf *buf, const void *from_,
         samples_count = can_write;
     }
 
-    uint32_t right_count = buf->alloc_size - head;
+    uint32_t slot = audiobuf_slot(buf, head);
+    uint32_t right_count = buf->alloc_size - slot;
     if (right_count > samples_count) {
         right_count = samples_count;
     }
-    memcpy(buf->data + (head * buf->sample_size),
+    memcpy(buf->data + (slot * buf->sample_size),
            from,
            right_count * buf->sample_size);
 
@@ -122,8 +215,9 @@ audiobuf_write(struct audiobuf *buf, const void *from_,
                left_count * buf->sample_size);
     }
 
-    uint32_t new_head = (head + samples_count) % buf->alloc_size;
+    uint32_t new_head = audiobuf_advance(buf, head, samples_count);
     atomic_store_explicit(&buf->head, new_head, memory_order_release);
+    futex_event_signal(&buf->notify);
 
     return samples_count;
 }
@@ -137,7 +231,7 @@ audiobuf_write_silence(struct audiobuf *buf, uint32_t samples_count) {
     // The tail cursor is updated after the data is consumed by the reader
     uint32_t tail = atomic_load_explicit(&buf->tail, memory_order_acquire);
 
-    uint32_t can_write = (buf->alloc_size + tail - head - 1) % buf->alloc_size;
+    uint32_t can_write = audiobuf_free(buf, head, tail);
     if (!can_write) {
         return 0;
     }
@@ -145,11 +239,12 @@ audiobuf_write_silence(struct audiobuf *buf, uint32_t samples_count) {
         samples_count = can_write;
     }
 
-    uint32_t right_count = buf->alloc_size - head;
+    uint32_t slot = audiobuf_slot(buf, head);
+    uint32_t right_count = buf->alloc_size - slot;
     if (right_count > samples_count) {
         right_count = samples_count;
     }
-    memset(buf->data + (head * buf->sample_size), 0,
+    memset(buf->data + (slot * buf->sample_size), 0,
            right_count * buf->sample_size);
 
     if (samples_count > right_count) {
@@ -157,8 +252,32 @@ audiobuf_write_silence(struct audiobuf *buf, uint32_t samples_count) {
         memset(buf->data, 0, left_count * buf->sample_size);
     }
 
-    uint32_t new_head = (head + samples_count) % buf->alloc_size;
+    uint32_t new_head = audiobuf_advance(buf, head, samples_count);
     atomic_store_explicit(&buf->head, new_head, memory_order_release);
+    futex_event_signal(&buf->notify);
 
     return samples_count;
 }
+
+struct audiobuf_wait_ctx {
+    struct audiobuf *buf;
+    uint32_t min_samples;
+};
+
+static bool
+audiobuf_can_read_min(void *ctx_) {
+    struct audiobuf_wait_ctx *ctx = ctx_;
+    return audiobuf_can_read(ctx->buf) >= ctx->min_samples;
+}
+
+uint32_t
+audiobuf_wait_can_read(struct audiobuf *buf, uint32_t min_samples,
+                       int timeout_ms) {
+    struct audiobuf_wait_ctx ctx = {
+        .buf = buf,
+        .min_samples = min_samples,
+    };
+    futex_event_wait_until(&buf->notify, audiobuf_can_read_min, &ctx,
+                           timeout_ms);
+    return audiobuf_can_read(buf);
+}
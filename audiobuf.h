@@ -7,6 +7,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "futex_event.h"
+
 #if defined (__cplusplus)
 extern "C" {
 #endif
@@ -19,12 +21,17 @@ extern "C" {
 struct audiobuf {
     uint8_t *data;
     uint32_t alloc_size; // in samples
+    uint32_t mask; // alloc_size - 1 in power-of-two mode, 0 otherwise
     size_t sample_size;
 
     atomic_uint_least32_t head; // writer cursor, in samples
     atomic_uint_least32_t tail; // reader cursor, in samples
     // empty: tail == head
     // full: ((tail + 1) % alloc_size) == head
+    // power-of-two mode: the cursors are free-running 32-bit counters,
+    // used = head - tail, full when used == alloc_size
+
+    struct futex_event notify; // wakes audiobuf_wait_can_read()
 };
 
 static inline uint32_t
@@ -38,16 +45,50 @@ audiobuf_to_bytes(struct audiobuf *buf, uint32_t samples) {
     return samples * buf->sample_size;
 }
 
+/**
+ * Zero-copy view into the ring, see audiobuf_acquire_read()
+ */
+struct audiobuf_span {
+    void *data;
+    uint32_t samples;
+};
+
 bool
 audiobuf_init(struct audiobuf *buf, size_t sample_size,
                  uint32_t capacity);
 
+/**
+ * Initialize in power-of-two mode: the capacity is min_capacity rounded up
+ * to a power of two, and cursor arithmetic uses masks instead of modulo.
+ */
+bool
+audiobuf_init_pow2(struct audiobuf *buf, size_t sample_size,
+                   uint32_t min_capacity);
+
 void
 audiobuf_destroy(struct audiobuf *buf);
 
 uint32_t
 audiobuf_read(struct audiobuf *buf, void *to, uint32_t samples_count);
 
+/**
+ * Expose up to max_samples readable samples in place, as at most two
+ * spans (the second one is used when the data wraps). Nothing is consumed
+ * until audiobuf_commit_read().
+ *
+ * @return the total number of samples in spans[0] and spans[1]
+ */
+uint32_t
+audiobuf_acquire_read(struct audiobuf *buf, uint32_t max_samples,
+                      struct audiobuf_span spans[2]);
+
+/**
+ * Release samples_count samples obtained from audiobuf_acquire_read(),
+ * publishing the reader cursor once.
+ */
+void
+audiobuf_commit_read(struct audiobuf *buf, uint32_t samples_count);
+
 uint32_t
 audiobuf_write(struct audiobuf *buf, const void *from,
                   uint32_t samples_count);
@@ -58,16 +99,32 @@ audiobuf_write_silence(struct audiobuf *buf, uint32_t samples);
 static inline uint32_t
 audiobuf_capacity(struct audiobuf *buf) {
     assert(buf->alloc_size);
-    return buf->alloc_size - 1;
+    return buf->mask ? buf->alloc_size : buf->alloc_size - 1;
 }
 
 static inline uint32_t
 audiobuf_can_read(struct audiobuf *buf) {
     uint32_t head = atomic_load_explicit(&buf->head, memory_order_acquire);
     uint32_t tail = atomic_load_explicit(&buf->tail, memory_order_acquire);
+    if (buf->mask) {
+        return head - tail;
+    }
     return (buf->alloc_size + head - tail) % buf->alloc_size;
 }
 
+/**
+ * Block the reader until at least min_samples can be read or timeout_ms
+ * elapses (negative means no timeout).
+ *
+ * The writer only issues a wake syscall while a reader is waiting here.
+ *
+ * @return the number of samples that can be read (below min_samples only
+ *         on timeout)
+ */
+uint32_t
+audiobuf_wait_can_read(struct audiobuf *buf, uint32_t min_samples,
+                       int timeout_ms);
+
 #if defined (__cplusplus)
 }
 #endif
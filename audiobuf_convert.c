@@ -0,0 +1,603 @@
+#include "audiobuf_convert.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+# define AUDIOBUF_X86
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define AUDIOBUF_HAVE_SSE2
+#  include <emmintrin.h>
+# endif
+# if defined(__GNUC__) || defined(__clang__)
+#  define AUDIOBUF_HAVE_AVX2
+#  define AUDIOBUF_TARGET_AVX2 __attribute__((target("avx2")))
+#  include <immintrin.h>
+# elif defined(_MSC_VER)
+#  define AUDIOBUF_HAVE_AVX2
+#  define AUDIOBUF_TARGET_AVX2
+#  include <immintrin.h>
+#  include <intrin.h>
+# endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+# define AUDIOBUF_HAVE_NEON
+# include <arm_neon.h>
+#endif
+
+#define S16_TO_F32 (1.0f / 32768.0f)
+#define S32_TO_F32 (1.0f / 2147483648.0f)
+#define F32_TO_S16 32768.0f
+#define F32_TO_S32 2147483648.0f
+// Largest float below 2^31, so that the clamped value fits in int32_t
+#define F32_S32_MAX 2147483520.0f
+
+size_t
+audiobuf_format_size(enum audiobuf_format format) {
+    switch (format) {
+        case AUDIOBUF_FORMAT_S16:
+            return sizeof(int16_t);
+        case AUDIOBUF_FORMAT_S32:
+            return sizeof(int32_t);
+        case AUDIOBUF_FORMAT_F32:
+            return sizeof(float);
+    }
+    assert(!"unknown format");
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Scalar reference
+// ---------------------------------------------------------------------------
+
+// Round half to even without libm, matching cvtps2dq / fcvtns
+static inline float
+round_even(float v) {
+    // Values of 2^23 or more are integers already
+    if (v >= 8388608.0f || v <= -8388608.0f) {
+        return v;
+    }
+    float magic = v >= 0.0f ? 8388608.0f : -8388608.0f;
+    return (v + magic) - magic;
+}
+
+static inline int16_t
+f32_to_s16_one(float v) {
+    v *= F32_TO_S16;
+    // Written so that NaN takes the lower bound, like maxps(v, min)
+    v = !(v > -32768.0f) ? -32768.0f : v;
+    v = v > 32767.0f ? 32767.0f : v;
+    return (int16_t) round_even(v);
+}
+
+static inline int32_t
+f32_to_s32_one(float v) {
+    v *= F32_TO_S32;
+    v = !(v > -F32_TO_S32) ? -F32_TO_S32 : v;
+    v = v > F32_S32_MAX ? F32_S32_MAX : v;
+    return (int32_t) round_even(v);
+}
+
+// Convert count values read every `stride` values of src
+static void
+convert_strided(enum audiobuf_format from, enum audiobuf_format to,
+                const uint8_t *src, size_t stride, uint8_t *dst,
+                size_t count) {
+    size_t in = audiobuf_format_size(from);
+    size_t out = audiobuf_format_size(to);
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t *s = src + i * stride * in;
+        uint8_t *d = dst + i * out;
+        int16_t s16;
+        int32_t s32;
+        float f32;
+        switch (from) {
+            case AUDIOBUF_FORMAT_S16:
+                memcpy(&s16, s, sizeof(s16));
+                s32 = (int32_t) s16 * 65536;
+                f32 = (float) s16 * S16_TO_F32;
+                break;
+            case AUDIOBUF_FORMAT_S32:
+                memcpy(&s32, s, sizeof(s32));
+                s16 = (int16_t) (s32 >> 16);
+                f32 = (float) s32 * S32_TO_F32;
+                break;
+            default:
+                memcpy(&f32, s, sizeof(f32));
+                s16 = f32_to_s16_one(f32);
+                s32 = f32_to_s32_one(f32);
+                break;
+        }
+        switch (to) {
+            case AUDIOBUF_FORMAT_S16:
+                memcpy(d, &s16, sizeof(s16));
+                break;
+            case AUDIOBUF_FORMAT_S32:
+                memcpy(d, &s32, sizeof(s32));
+                break;
+            default:
+                memcpy(d, &f32, sizeof(f32));
+                break;
+        }
+    }
+}
+
+static void
+s16_to_f32_scalar(const int16_t *src, float *dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = (float) src[i] * S16_TO_F32;
+    }
+}
+
+static void
+f32_to_s16_scalar(const float *src, int16_t *dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = f32_to_s16_one(src[i]);
+    }
+}
+
+static void
+s32_to_f32_scalar(const int32_t *src, float *dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = (float) src[i] * S32_TO_F32;
+    }
+}
+
+static void
+f32_to_s32_scalar(const float *src, int32_t *dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = f32_to_s32_one(src[i]);
+    }
+}
+
+static void
+s16_to_f32_deint2_scalar(const int16_t *src, float *left, float *right,
+                         size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        left[i] = (float) src[2 * i] * S16_TO_F32;
+        right[i] = (float) src[2 * i + 1] * S16_TO_F32;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// SSE2
+// ---------------------------------------------------------------------------
+
+#ifdef AUDIOBUF_HAVE_SSE2
+static void
+s16_to_f32_sse2(const int16_t *src, float *dst, size_t count) {
+    const __m128 scale = _mm_set1_ps(S16_TO_F32);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+        // Sign-extend by placing each value in the high half of a lane
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    s16_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+static void
+f32_to_s16_sse2(const float *src, int16_t *dst, size_t count) {
+    const __m128 scale = _mm_set1_ps(F32_TO_S16);
+    const __m128 min = _mm_set1_ps(-32768.0f);
+    const __m128 max = _mm_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+        a = _mm_min_ps(_mm_max_ps(a, min), max);
+        b = _mm_min_ps(_mm_max_ps(b, min), max);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128((__m128i *) (dst + i), packed);
+    }
+    f32_to_s16_scalar(src + i, dst + i, count - i);
+}
+
+static void
+s32_to_f32_sse2(const int32_t *src, float *dst, size_t count) {
+    const __m128 scale = _mm_set1_ps(S32_TO_F32);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    s32_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+static void
+f32_to_s32_sse2(const float *src, int32_t *dst, size_t count) {
+    const __m128 scale = _mm_set1_ps(F32_TO_S32);
+    const __m128 min = _mm_set1_ps(-F32_TO_S32);
+    const __m128 max = _mm_set1_ps(F32_S32_MAX);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        v = _mm_min_ps(_mm_max_ps(v, min), max);
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_cvtps_epi32(v));
+    }
+    f32_to_s32_scalar(src + i, dst + i, count - i);
+}
+
+static void
+s16_to_f32_deint2_sse2(const int16_t *src, float *left, float *right,
+                       size_t frames) {
+    const __m128 scale = _mm_set1_ps(S16_TO_F32);
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        // L R L R ...: each 32-bit lane holds one frame
+        __m128i v = _mm_loadu_si128((const __m128i *) (src + 2 * i));
+        __m128i l = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+        __m128i r = _mm_srai_epi32(v, 16);
+        _mm_storeu_ps(left + i, _mm_mul_ps(_mm_cvtepi32_ps(l), scale));
+        _mm_storeu_ps(right + i, _mm_mul_ps(_mm_cvtepi32_ps(r), scale));
+    }
+    s16_to_f32_deint2_scalar(src + 2 * i, left + i, right + i, frames - i);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// AVX2
+// ---------------------------------------------------------------------------
+
+#ifdef AUDIOBUF_HAVE_AVX2
+AUDIOBUF_TARGET_AVX2 static void
+s16_to_f32_avx2(const int16_t *src, float *dst, size_t count) {
+    const __m256 scale = _mm256_set1_ps(S16_TO_F32);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (src + i + 8));
+        __m256 fa = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a));
+        __m256 fb = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(fa, scale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(fb, scale));
+    }
+    s16_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+AUDIOBUF_TARGET_AVX2 static void
+f32_to_s16_avx2(const float *src, int16_t *dst, size_t count) {
+    const __m256 scale = _mm256_set1_ps(F32_TO_S16);
+    const __m256 min = _mm256_set1_ps(-32768.0f);
+    const __m256 max = _mm256_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale);
+        a = _mm256_min_ps(_mm256_max_ps(a, min), max);
+        b = _mm256_min_ps(_mm256_max_ps(b, min), max);
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a),
+                                            _mm256_cvtps_epi32(b));
+        // packs works per 128-bit lane: a0 b0 a1 b1 -> a0 a1 b0 b1
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256((__m256i *) (dst + i), packed);
+    }
+    f32_to_s16_scalar(src + i, dst + i, count - i);
+}
+
+AUDIOBUF_TARGET_AVX2 static void
+s32_to_f32_avx2(const int32_t *src, float *dst, size_t count) {
+    const __m256 scale = _mm256_set1_ps(S32_TO_F32);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (src + i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    s32_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+AUDIOBUF_TARGET_AVX2 static void
+f32_to_s32_avx2(const float *src, int32_t *dst, size_t count) {
+    const __m256 scale = _mm256_set1_ps(F32_TO_S32);
+    const __m256 min = _mm256_set1_ps(-F32_TO_S32);
+    const __m256 max = _mm256_set1_ps(F32_S32_MAX);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        v = _mm256_min_ps(_mm256_max_ps(v, min), max);
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_cvtps_epi32(v));
+    }
+    f32_to_s32_scalar(src + i, dst + i, count - i);
+}
+
+AUDIOBUF_TARGET_AVX2 static void
+s16_to_f32_deint2_avx2(const int16_t *src, float *left, float *right,
+                       size_t frames) {
+    const __m256 scale = _mm256_set1_ps(S16_TO_F32);
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (src + 2 * i));
+        __m256i l = _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+        __m256i r = _mm256_srai_epi32(v, 16);
+        _mm256_storeu_ps(left + i, _mm256_mul_ps(_mm256_cvtepi32_ps(l), scale));
+        _mm256_storeu_ps(right + i, _mm256_mul_ps(_mm256_cvtepi32_ps(r), scale));
+    }
+    s16_to_f32_deint2_scalar(src + 2 * i, left + i, right + i, frames - i);
+}
+
+static bool
+cpu_has_avx2(void) {
+# if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // OSXSAVE and AVX, and the OS saves the YMM registers
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0
+            || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+# else
+    return __builtin_cpu_supports("avx2");
+# endif
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// NEON
+// ---------------------------------------------------------------------------
+
+#ifdef AUDIOBUF_HAVE_NEON
+static void
+s16_to_f32_neon(const int16_t *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(src + i);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+        vst1q_f32(dst + i, vmulq_n_f32(lo, S16_TO_F32));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(hi, S16_TO_F32));
+    }
+    s16_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+static void
+f32_to_s16_neon(const float *src, int16_t *dst, size_t count) {
+    const float32x4_t min = vdupq_n_f32(-32768.0f);
+    const float32x4_t max = vdupq_n_f32(32767.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vmulq_n_f32(vld1q_f32(src + i), F32_TO_S16);
+        float32x4_t b = vmulq_n_f32(vld1q_f32(src + i + 4), F32_TO_S16);
+        // vmaxnm maps NaN to min, like the scalar and x86 kernels
+        a = vminq_f32(vmaxnmq_f32(a, min), max);
+        b = vminq_f32(vmaxnmq_f32(b, min), max);
+        int16x8_t packed = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)),
+                                        vqmovn_s32(vcvtnq_s32_f32(b)));
+        vst1q_s16(dst + i, packed);
+    }
+    f32_to_s16_scalar(src + i, dst + i, count - i);
+}
+
+static void
+s32_to_f32_neon(const int32_t *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t v = vcvtq_f32_s32(vld1q_s32(src + i));
+        vst1q_f32(dst + i, vmulq_n_f32(v, S32_TO_F32));
+    }
+    s32_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+static void
+f32_to_s32_neon(const float *src, int32_t *dst, size_t count) {
+    const float32x4_t min = vdupq_n_f32(-F32_TO_S32);
+    const float32x4_t max = vdupq_n_f32(F32_S32_MAX);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t v = vmulq_n_f32(vld1q_f32(src + i), F32_TO_S32);
+        v = vminq_f32(vmaxnmq_f32(v, min), max);
+        vst1q_s32(dst + i, vcvtnq_s32_f32(v));
+    }
+    f32_to_s32_scalar(src + i, dst + i, count - i);
+}
+
+static void
+s16_to_f32_deint2_neon(const int16_t *src, float *left, float *right,
+                       size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        int16x4x2_t v = vld2_s16(src + 2 * i);
+        vst1q_f32(left + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(v.val[0])),
+                                        S16_TO_F32));
+        vst1q_f32(right + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(v.val[1])),
+                                         S16_TO_F32));
+    }
+    s16_to_f32_deint2_scalar(src + 2 * i, left + i, right + i, frames - i);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+struct audiobuf_kernels {
+    enum audiobuf_simd simd;
+    void (*s16_to_f32)(const int16_t *src, float *dst, size_t count);
+    void (*f32_to_s16)(const float *src, int16_t *dst, size_t count);
+    void (*s32_to_f32)(const int32_t *src, float *dst, size_t count);
+    void (*f32_to_s32)(const float *src, int32_t *dst, size_t count);
+    void (*s16_to_f32_deint2)(const int16_t *src, float *left, float *right,
+                              size_t frames);
+};
+
+static const struct audiobuf_kernels kernels_scalar = {
+    AUDIOBUF_SIMD_SCALAR, s16_to_f32_scalar, f32_to_s16_scalar,
+    s32_to_f32_scalar, f32_to_s32_scalar, s16_to_f32_deint2_scalar,
+};
+#ifdef AUDIOBUF_HAVE_SSE2
+static const struct audiobuf_kernels kernels_sse2 = {
+    AUDIOBUF_SIMD_SSE2, s16_to_f32_sse2, f32_to_s16_sse2,
+    s32_to_f32_sse2, f32_to_s32_sse2, s16_to_f32_deint2_sse2,
+};
+#endif
+#ifdef AUDIOBUF_HAVE_AVX2
+static const struct audiobuf_kernels kernels_avx2 = {
+    AUDIOBUF_SIMD_AVX2, s16_to_f32_avx2, f32_to_s16_avx2,
+    s32_to_f32_avx2, f32_to_s32_avx2, s16_to_f32_deint2_avx2,
+};
+#endif
+#ifdef AUDIOBUF_HAVE_NEON
+static const struct audiobuf_kernels kernels_neon = {
+    AUDIOBUF_SIMD_NEON, s16_to_f32_neon, f32_to_s16_neon,
+    s32_to_f32_neon, f32_to_s32_neon, s16_to_f32_deint2_neon,
+};
+#endif
+
+static _Atomic(const struct audiobuf_kernels *) kernels_current;
+
+static const struct audiobuf_kernels *
+kernels_for(enum audiobuf_simd simd) {
+    switch (simd) {
+        case AUDIOBUF_SIMD_SCALAR:
+            return &kernels_scalar;
+#ifdef AUDIOBUF_HAVE_SSE2
+        case AUDIOBUF_SIMD_SSE2:
+            return &kernels_sse2;
+#endif
+#ifdef AUDIOBUF_HAVE_AVX2
+        case AUDIOBUF_SIMD_AVX2:
+            return cpu_has_avx2() ? &kernels_avx2 : NULL;
+#endif
+#ifdef AUDIOBUF_HAVE_NEON
+        case AUDIOBUF_SIMD_NEON:
+            return &kernels_neon;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+static const struct audiobuf_kernels *
+kernels_get(void) {
+    const struct audiobuf_kernels *k =
+        atomic_load_explicit(&kernels_current, memory_order_acquire);
+    if (!k) {
+        // Detection is idempotent, racing initializations agree
+        static const enum audiobuf_simd preferred[] = {
+            AUDIOBUF_SIMD_AVX2, AUDIOBUF_SIMD_SSE2, AUDIOBUF_SIMD_NEON,
+            AUDIOBUF_SIMD_SCALAR,
+        };
+        for (size_t i = 0; !k; ++i) {
+            k = kernels_for(preferred[i]);
+        }
+        atomic_store_explicit(&kernels_current, k, memory_order_release);
+    }
+    return k;
+}
+
+enum audiobuf_simd
+audiobuf_simd_current(void) {
+    return kernels_get()->simd;
+}
+
+bool
+audiobuf_simd_select(enum audiobuf_simd simd) {
+    const struct audiobuf_kernels *k = kernels_for(simd);
+    if (!k) {
+        return false;
+    }
+    atomic_store_explicit(&kernels_current, k, memory_order_release);
+    return true;
+}
+
+void
+audiobuf_convert(enum audiobuf_format from, enum audiobuf_format to,
+                 const void *src, void *dst, size_t count) {
+    const struct audiobuf_kernels *k = kernels_get();
+    if (from == to) {
+        memcpy(dst, src, count * audiobuf_format_size(from));
+    } else if (from == AUDIOBUF_FORMAT_S16 && to == AUDIOBUF_FORMAT_F32) {
+        k->s16_to_f32(src, dst, count);
+    } else if (from == AUDIOBUF_FORMAT_F32 && to == AUDIOBUF_FORMAT_S16) {
+        k->f32_to_s16(src, dst, count);
+    } else if (from == AUDIOBUF_FORMAT_S32 && to == AUDIOBUF_FORMAT_F32) {
+        k->s32_to_f32(src, dst, count);
+    } else if (from == AUDIOBUF_FORMAT_F32 && to == AUDIOBUF_FORMAT_S32) {
+        k->f32_to_s32(src, dst, count);
+    } else {
+        convert_strided(from, to, src, 1, dst, count);
+    }
+}
+
+void
+audiobuf_deinterleave(enum audiobuf_format from, enum audiobuf_format to,
+                      const void *src, void *const *planes,
+                      size_t plane_offset, unsigned channels, size_t frames) {
+    size_t out = audiobuf_format_size(to);
+    if (channels == 2 && from == AUDIOBUF_FORMAT_S16
+            && to == AUDIOBUF_FORMAT_F32) {
+        kernels_get()->s16_to_f32_deint2(src, (float *) planes[0] + plane_offset,
+                                         (float *) planes[1] + plane_offset,
+                                         frames);
+        return;
+    }
+    size_t in = audiobuf_format_size(from);
+    for (unsigned c = 0; c < channels; ++c) {
+        uint8_t *plane = (uint8_t *) planes[c] + plane_offset * out;
+        if (channels == 1) {
+            audiobuf_convert(from, to, src, plane, frames);
+        } else {
+            convert_strided(from, to, (const uint8_t *) src + c * in, channels,
+                            plane, frames);
+        }
+    }
+}
+
+static unsigned
+audiobuf_channels(struct audiobuf *buf, enum audiobuf_format from) {
+    size_t in = audiobuf_format_size(from);
+    assert(buf->sample_size % in == 0);
+    return (unsigned) (buf->sample_size / in);
+}
+
+uint32_t
+audiobuf_read_convert(struct audiobuf *buf, enum audiobuf_format from,
+                      enum audiobuf_format to, void *dst_,
+                      uint32_t samples_count) {
+    uint8_t *dst = dst_;
+    unsigned channels = audiobuf_channels(buf, from);
+    size_t frame_out = channels * audiobuf_format_size(to);
+
+    struct audiobuf_span spans[2];
+    uint32_t count = audiobuf_acquire_read(buf, samples_count, spans);
+    if (!count) {
+        return 0;
+    }
+    audiobuf_convert(from, to, spans[0].data, dst,
+                     (size_t) spans[0].samples * channels);
+    if (spans[1].samples) {
+        audiobuf_convert(from, to, spans[1].data,
+                         dst + spans[0].samples * frame_out,
+                         (size_t) spans[1].samples * channels);
+    }
+    audiobuf_commit_read(buf, count);
+    return count;
+}
+
+uint32_t
+audiobuf_read_deinterleave(struct audiobuf *buf, enum audiobuf_format from,
+                           enum audiobuf_format to, void *const *planes,
+                           uint32_t samples_count) {
+    unsigned channels = audiobuf_channels(buf, from);
+
+    struct audiobuf_span spans[2];
+    uint32_t count = audiobuf_acquire_read(buf, samples_count, spans);
+    if (!count) {
+        return 0;
+    }
+    audiobuf_deinterleave(from, to, spans[0].data, planes, 0, channels,
+                          spans[0].samples);
+    if (spans[1].samples) {
+        audiobuf_deinterleave(from, to, spans[1].data, planes,
+                              spans[0].samples, channels, spans[1].samples);
+    }
+    audiobuf_commit_read(buf, count);
+    return count;
+}
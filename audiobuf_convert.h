@@ -0,0 +1,93 @@
+#ifndef SC_AUDIOBUF_CONVERT_H
+#define SC_AUDIOBUF_CONVERT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "audiobuf.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Sample formats, one value per channel
+ *
+ * Floats are normalized to [-1, 1); converting to integers clamps and
+ * rounds to nearest.
+ */
+enum audiobuf_format {
+    AUDIOBUF_FORMAT_S16,
+    AUDIOBUF_FORMAT_S32,
+    AUDIOBUF_FORMAT_F32,
+};
+
+/**
+ * Conversion kernel implementations, the best supported one is selected
+ * at runtime
+ */
+enum audiobuf_simd {
+    AUDIOBUF_SIMD_SCALAR,
+    AUDIOBUF_SIMD_SSE2,
+    AUDIOBUF_SIMD_AVX2,
+    AUDIOBUF_SIMD_NEON,
+};
+
+size_t
+audiobuf_format_size(enum audiobuf_format format);
+
+/**
+ * Return the kernels in use (detected on first use)
+ */
+enum audiobuf_simd
+audiobuf_simd_current(void);
+
+/**
+ * Force a kernel implementation, mainly for tests and benchmarks
+ *
+ * @return false if the CPU or the build does not support it
+ */
+bool
+audiobuf_simd_select(enum audiobuf_simd simd);
+
+/**
+ * Convert count interleaved values from one format to another
+ */
+void
+audiobuf_convert(enum audiobuf_format from, enum audiobuf_format to,
+                 const void *src, void *dst, size_t count);
+
+/**
+ * Convert frames interleaved frames of `channels` values into one plane
+ * per channel, writing at planes[c][plane_offset]
+ */
+void
+audiobuf_deinterleave(enum audiobuf_format from, enum audiobuf_format to,
+                      const void *src, void *const *planes,
+                      size_t plane_offset, unsigned channels, size_t frames);
+
+/**
+ * Like audiobuf_read(), but convert each value from `from` (the format
+ * stored in the buffer, sample_size must be a multiple of its size) to
+ * `to` while copying out of the ring.
+ *
+ * @return the number of samples (frames) read
+ */
+uint32_t
+audiobuf_read_convert(struct audiobuf *buf, enum audiobuf_format from,
+                      enum audiobuf_format to, void *dst,
+                      uint32_t samples_count);
+
+/**
+ * Like audiobuf_read_convert(), but write one plane per channel
+ */
+uint32_t
+audiobuf_read_deinterleave(struct audiobuf *buf, enum audiobuf_format from,
+                           enum audiobuf_format to, void *const *planes,
+                           uint32_t samples_count);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif
@@ -0,0 +1,104 @@
+// Throughput of the audiobuf sample conversion kernels.
+// usage: audiobuf_convert_bench [megasamples]
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L // clock_gettime() under -std=c11
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "audiobuf_convert.h"
+
+static const char *simd_names[] = { "scalar", "sse2", "avx2", "neon" };
+
+static double
+now_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart / (double) freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+// 64 samples per read, like a 48kHz stereo stream polled in small bursts
+#define BURST 64
+#define RING_FRAMES 4096
+
+static double
+bench_read_convert(enum audiobuf_format from, enum audiobuf_format to,
+                   unsigned channels, int planar, size_t total_frames) {
+    struct audiobuf buf;
+    if (!audiobuf_init_pow2(&buf, channels * audiobuf_format_size(from),
+                            RING_FRAMES)) {
+        return 0;
+    }
+    uint8_t *frames = calloc(RING_FRAMES, buf.sample_size);
+    float *out = malloc(BURST * channels * sizeof(float) * 2);
+    void *planes[8];
+    for (unsigned c = 0; c < channels; ++c) {
+        planes[c] = (uint8_t *) out + c * BURST * audiobuf_format_size(to);
+    }
+
+    double start = now_seconds();
+    for (size_t done = 0; done < total_frames;) {
+        if (audiobuf_can_read(&buf) < BURST) {
+            audiobuf_write(&buf, frames, RING_FRAMES / 2);
+        }
+        done += planar
+            ? audiobuf_read_deinterleave(&buf, from, to, planes, BURST)
+            : audiobuf_read_convert(&buf, from, to, out, BURST);
+    }
+    double elapsed = now_seconds() - start;
+
+    free(out);
+    free(frames);
+    audiobuf_destroy(&buf);
+    return total_frames * channels / elapsed / 1e6;
+}
+
+int
+main(int argc, char **argv) {
+    size_t total = (argc > 1 ? strtoul(argv[1], NULL, 10) : 64) * 1000000;
+    struct {
+        const char *name;
+        enum audiobuf_format from, to;
+        int planar;
+    } cases[] = {
+        { "s16->f32", AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_F32, 0 },
+        { "s16->f32 planar", AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_F32, 1 },
+        { "f32->s16", AUDIOBUF_FORMAT_F32, AUDIOBUF_FORMAT_S16, 0 },
+        { "s32->f32", AUDIOBUF_FORMAT_S32, AUDIOBUF_FORMAT_F32, 0 },
+    };
+
+    printf("stereo, %d-frame reads, %zu M values per run (Msamples/s)\n",
+           BURST, total / 1000000);
+    printf("%-18s", "");
+    for (int simd = AUDIOBUF_SIMD_SCALAR; simd <= AUDIOBUF_SIMD_NEON; ++simd) {
+        printf("%10s", simd_names[simd]);
+    }
+    printf("\n");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        printf("%-18s", cases[i].name);
+        for (int simd = AUDIOBUF_SIMD_SCALAR; simd <= AUDIOBUF_SIMD_NEON; ++simd) {
+            if (!audiobuf_simd_select((enum audiobuf_simd) simd)) {
+                printf("%10s", "-");
+                continue;
+            }
+            printf("%10.0f", bench_read_convert(cases[i].from, cases[i].to, 2,
+                                                cases[i].planar, total / 2));
+        }
+        printf("\n");
+    }
+    return 0;
+}
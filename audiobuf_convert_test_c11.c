@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h> // NAN, INFINITY
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// 包含被测试的头文件
+#include "audiobuf_convert.h"
+
+// --- 简单的断言宏，用于提供更清晰的输出 ---
+#define ASSERT(condition)                                           \
+    do {                                                            \
+        if (!(condition)) {                                         \
+            fprintf(stderr, "Assertion failed: %s, file %s, line %d\n", \
+                    #condition, __FILE__, __LINE__);                \
+            exit(1);                                                \
+        }                                                           \
+    } while (0)
+
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+#define ASSERT_TRUE(a) ASSERT((a))
+
+static const char *simd_names[] = { "scalar", "sse2", "avx2", "neon" };
+
+// 奇数长度，覆盖 SIMD 主循环之后的标量尾部
+#define COUNT 1003
+
+static uint32_t rng_state = 12345;
+static uint32_t next_random(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state;
+}
+
+// --- 测试实现 ---
+
+void test_scalar_reference() {
+    printf("Running: test_scalar_reference\n");
+    ASSERT_TRUE(audiobuf_simd_select(AUDIOBUF_SIMD_SCALAR));
+
+    int16_t s16[4] = { -32768, 16384, 0, 32767 };
+    float f32[4];
+    audiobuf_convert(AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_F32, s16, f32, 4);
+    ASSERT_EQ(f32[0], -1.0f);
+    ASSERT_EQ(f32[1], 0.5f);
+    ASSERT_EQ(f32[2], 0.0f);
+
+    // 超出范围时截断，0.5 个量化步长按“四舍六入五成双”舍入
+    float in[6] = { 1.0f, -1.5f, 0.5f, 0.5f / 32768.0f, 1.5f / 32768.0f, -0.25f };
+    int16_t out[6];
+    audiobuf_convert(AUDIOBUF_FORMAT_F32, AUDIOBUF_FORMAT_S16, in, out, 6);
+    ASSERT_EQ(out[0], 32767);
+    ASSERT_EQ(out[1], -32768);
+    ASSERT_EQ(out[2], 16384);
+    ASSERT_EQ(out[3], 0);
+    ASSERT_EQ(out[4], 2);
+    ASSERT_EQ(out[5], -8192);
+
+    int32_t s32[2];
+    float big[2] = { 2.0f, -2.0f };
+    audiobuf_convert(AUDIOBUF_FORMAT_F32, AUDIOBUF_FORMAT_S32, big, s32, 2);
+    ASSERT_EQ(s32[0], 2147483520);
+    ASSERT_EQ(s32[1], INT32_MIN);
+
+    // NaN 与所有 SIMD 实现一致地映射到下限，无穷大照常截断
+    float special[3] = { NAN, INFINITY, -INFINITY };
+    int16_t special_s16[3];
+    int32_t special_s32[3];
+    audiobuf_convert(AUDIOBUF_FORMAT_F32, AUDIOBUF_FORMAT_S16, special, special_s16, 3);
+    ASSERT_EQ(special_s16[0], -32768);
+    ASSERT_EQ(special_s16[1], 32767);
+    ASSERT_EQ(special_s16[2], -32768);
+    audiobuf_convert(AUDIOBUF_FORMAT_F32, AUDIOBUF_FORMAT_S32, special, special_s32, 3);
+    ASSERT_EQ(special_s32[0], INT32_MIN);
+    ASSERT_EQ(special_s32[1], 2147483520);
+    ASSERT_EQ(special_s32[2], INT32_MIN);
+
+    // 整数格式之间移位转换
+    int32_t wide[4];
+    audiobuf_convert(AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_S32, s16, wide, 4);
+    ASSERT_EQ(wide[1], 16384 * 65536);
+    int16_t narrow[4];
+    audiobuf_convert(AUDIOBUF_FORMAT_S32, AUDIOBUF_FORMAT_S16, wide, narrow, 4);
+    ASSERT_EQ(memcmp(narrow, s16, sizeof(s16)), 0);
+}
+
+// 每个可用的 SIMD 实现都必须和标量实现逐位一致
+void test_simd_matches_scalar() {
+    printf("Running: test_simd_matches_scalar\n");
+    static int16_t s16[COUNT];
+    static int32_t s32[COUNT];
+    static float f32[COUNT];
+    for (int i = 0; i < COUNT; ++i) {
+        s16[i] = (int16_t)next_random();
+        s32[i] = (int32_t)next_random();
+        // [-1.5, 1.5)，包含需要截断的值
+        f32[i] = ((float)(next_random() >> 8) / 16777216.0f) * 3.0f - 1.5f;
+    }
+    f32[0] = 0.5f / 32768.0f; // 舍入边界
+    f32[1] = 1.0f;
+    // 特殊值放在 SIMD 主循环覆盖的位置
+    f32[2] = NAN;
+    f32[3] = -NAN;
+    f32[5] = INFINITY;
+    f32[6] = -INFINITY;
+
+    static float ref_f32[COUNT], out_f32[COUNT];
+    static int16_t ref_s16[COUNT], out_s16[COUNT];
+    static int32_t ref_s32[COUNT], out_s32[COUNT];
+    static float ref_l[COUNT / 2], ref_r[COUNT / 2], out_l[COUNT / 2], out_r[COUNT / 2];
+
+    for (int simd = AUDIOBUF_SIMD_SSE2; simd <= AUDIOBUF_SIMD_NEON; ++simd) {
+        if (!audiobuf_simd_select((enum audiobuf_simd)simd)) {
+            printf("  %s: not supported, skipped\n", simd_names[simd]);
+            continue;
+        }
+        printf("  %s\n", simd_names[simd]);
+
+        ASSERT_TRUE(audiobuf_simd_select(AUDIOBUF_SIMD_SCALAR));
+        audiobuf_convert(AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_F32, s16, ref_f32, COUNT);
+        audiobuf_simd_select((enum audiobuf_simd)simd);
+        audiobuf_convert(AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_F32, s16, out_f32, COUNT);
+        ASSERT_EQ(memcmp(ref_f32, out_f32, sizeof(ref_f32)), 0);
+
+        audiobuf_simd_select(AUDIOBUF_SIMD_SCALAR);
+        audiobuf_convert(AUDIOBUF_FORMAT_S32, AUDIOBUF_FORMAT_F32, s32, ref_f32, COUNT);
+        audiobuf_simd_select((enum audiobuf_simd)simd);
+        audiobuf_convert(AUDIOBUF_FORMAT_S32, AUDIOBUF_FORMAT_F32, s32, out_f32, COUNT);
+        ASSERT_EQ(memcmp(ref_f32, out_f32, sizeof(ref_f32)), 0);
+
+        audiobuf_simd_select(AUDIOBUF_SIMD_SCALAR);
+        audiobuf_convert(AUDIOBUF_FORMAT_F32, AUDIOBUF_FORMAT_S16, f32, ref_s16, COUNT);
+        audiobuf_simd_select((enum audiobuf_simd)simd);
+        audiobuf_convert(AUDIOBUF_FORMAT_F32, AUDIOBUF_FORMAT_S16, f32, out_s16, COUNT);
+        ASSERT_EQ(memcmp(ref_s16, out_s16, sizeof(ref_s16)), 0);
+
+        audiobuf_simd_select(AUDIOBUF_SIMD_SCALAR);
+        audiobuf_convert(AUDIOBUF_FORMAT_F32, AUDIOBUF_FORMAT_S32, f32, ref_s32, COUNT);
+        audiobuf_simd_select((enum audiobuf_simd)simd);
+        audiobuf_convert(AUDIOBUF_FORMAT_F32, AUDIOBUF_FORMAT_S32, f32, out_s32, COUNT);
+        ASSERT_EQ(memcmp(ref_s32, out_s32, sizeof(ref_s32)), 0);
+
+        void *ref_planes[2] = { ref_l, ref_r };
+        void *out_planes[2] = { out_l, out_r };
+        audiobuf_simd_select(AUDIOBUF_SIMD_SCALAR);
+        audiobuf_deinterleave(AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_F32, s16, ref_planes, 0, 2, COUNT / 2);
+        audiobuf_simd_select((enum audiobuf_simd)simd);
+        audiobuf_deinterleave(AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_F32, s16, out_planes, 0, 2, COUNT / 2);
+        ASSERT_EQ(memcmp(ref_l, out_l, sizeof(ref_l)), 0);
+        ASSERT_EQ(memcmp(ref_r, out_r, sizeof(ref_r)), 0);
+    }
+}
+
+// 从环形缓冲区读出时转换格式，数据跨越缓冲区末尾
+void test_read_convert_wrap() {
+    printf("Running: test_read_convert_wrap\n");
+    for (int simd = AUDIOBUF_SIMD_SCALAR; simd <= AUDIOBUF_SIMD_NEON; ++simd) {
+        if (!audiobuf_simd_select((enum audiobuf_simd)simd)) {
+            continue;
+        }
+        struct audiobuf buf;
+        ASSERT_TRUE(audiobuf_init_pow2(&buf, 2 * sizeof(int16_t), 64)); // 立体声 S16
+
+        int16_t frames[2 * 64];
+        for (int i = 0; i < 2 * 64; ++i) {
+            frames[i] = (int16_t)(i * 100 - 6000);
+        }
+        ASSERT_EQ(audiobuf_write(&buf, frames, 50), 50);
+        ASSERT_EQ(audiobuf_read(&buf, NULL, 50), 50);
+        ASSERT_EQ(audiobuf_write(&buf, frames, 40), 40); // 跨越末尾
+
+        float interleaved[2 * 40];
+        ASSERT_EQ(audiobuf_read_convert(&buf, AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_F32,
+                                        interleaved, 20), 20);
+        for (int i = 0; i < 2 * 20; ++i) {
+            ASSERT_EQ(interleaved[i], frames[i] / 32768.0f);
+        }
+
+        float left[20], right[20];
+        void *planes[2] = { left, right };
+        ASSERT_EQ(audiobuf_read_deinterleave(&buf, AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_F32,
+                                             planes, 64), 20);
+        for (int i = 0; i < 20; ++i) {
+            ASSERT_EQ(left[i], frames[2 * (20 + i)] / 32768.0f);
+            ASSERT_EQ(right[i], frames[2 * (20 + i) + 1] / 32768.0f);
+        }
+        ASSERT_EQ(audiobuf_can_read(&buf), 0);
+        ASSERT_EQ(audiobuf_read_convert(&buf, AUDIOBUF_FORMAT_S16, AUDIOBUF_FORMAT_F32,
+                                        interleaved, 20), 0);
+        audiobuf_destroy(&buf);
+    }
+}
+
+// 三声道 F32 -> S32 平面输出，走通用路径
+void test_read_deinterleave_generic() {
+    printf("Running: test_read_deinterleave_generic\n");
+    struct audiobuf buf;
+    ASSERT_TRUE(audiobuf_init(&buf, 3 * sizeof(float), 16));
+
+    float frames[3 * 10];
+    for (int i = 0; i < 3 * 10; ++i) {
+        frames[i] = (float)i / 64.0f;
+    }
+    ASSERT_EQ(audiobuf_write(&buf, frames, 10), 10);
+
+    int32_t planes_data[3][10];
+    void *planes[3] = { planes_data[0], planes_data[1], planes_data[2] };
+    ASSERT_EQ(audiobuf_read_deinterleave(&buf, AUDIOBUF_FORMAT_F32, AUDIOBUF_FORMAT_S32,
+                                         planes, 10), 10);
+    for (int f = 0; f < 10; ++f) {
+        for (int c = 0; c < 3; ++c) {
+            ASSERT_EQ(planes_data[c][f], (int32_t)((3 * f + c) * (2147483648.0 / 64.0)));
+        }
+    }
+    audiobuf_destroy(&buf);
+}
+
+
+// --- 主函数 ---
+int main() {
+    printf("--- Starting audiobuf_convert C11 tests ---\n");
+    ASSERT_TRUE(audiobuf_simd_current() <= AUDIOBUF_SIMD_NEON);
+    printf("detected kernels: %s\n", simd_names[audiobuf_simd_current()]);
+
+    test_scalar_reference();
+    test_simd_matches_scalar();
+    test_read_convert_wrap();
+    test_read_deinterleave_generic();
+
+    printf("--- All audiobuf_convert C11 tests passed! ---\n");
+    return 0;
+}
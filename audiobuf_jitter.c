@@ -0,0 +1,209 @@
+#include "audiobuf_jitter.h"
+
+#include <string.h>
+
+// Time constants of the fill average, of the proportional correction and
+// of the drift estimate (integral term, slow enough for critical damping)
+#define AVERAGE_SECONDS 1.0f
+#define SETTLE_SECONDS 2.0f
+#define DRIFT_SECONDS 16.0f
+
+bool
+audiobuf_jitter_init(struct audiobuf_jitter *jb, size_t sample_size,
+                     const struct audiobuf_jitter_config *config) {
+    assert(config->sample_rate);
+    assert(config->target_ms);
+
+    uint32_t max_ms = config->max_ms ? config->max_ms : 3 * config->target_ms;
+    assert(max_ms > config->target_ms);
+    uint32_t ppm = config->max_correction_ppm ? config->max_correction_ppm
+                                              : 5000;
+
+    jb->sample_rate = config->sample_rate;
+    jb->target = (uint32_t) ((uint64_t) config->sample_rate
+                             * config->target_ms / 1000);
+    jb->max = (uint32_t) ((uint64_t) config->sample_rate * max_ms / 1000);
+    jb->max_correction = ppm / 1e6f;
+
+    // Room for max plus the bursts pushed before the consumer trims it
+    if (!audiobuf_init_pow2(&jb->buf, sample_size, 2 * jb->max)) {
+        return false;
+    }
+
+    jb->playing = false;
+    jb->avg_fill = (float) jb->target;
+    jb->drift = 0;
+    jb->correction_acc = 0;
+
+    atomic_init(&jb->underruns, 0);
+    atomic_init(&jb->overruns, 0);
+    atomic_init(&jb->dropped, 0);
+    atomic_init(&jb->inserted, 0);
+    atomic_init(&jb->skipped, 0);
+    atomic_init(&jb->avg_fill_frames, jb->target);
+    return true;
+}
+
+void
+audiobuf_jitter_destroy(struct audiobuf_jitter *jb) {
+    audiobuf_destroy(&jb->buf);
+}
+
+static inline void
+counter_add(atomic_uint_fast64_t *counter, uint64_t n) {
+    // overruns and dropped are updated by both sides
+    atomic_fetch_add_explicit(counter, n, memory_order_relaxed);
+}
+
+uint32_t
+audiobuf_jitter_push(struct audiobuf_jitter *jb, const void *frames,
+                     uint32_t count) {
+    uint32_t written = audiobuf_write(&jb->buf, frames, count);
+    if (written < count) {
+        counter_add(&jb->overruns, 1);
+        counter_add(&jb->dropped, count - written);
+    }
+    return written;
+}
+
+static inline float
+clamp_correction(struct audiobuf_jitter *jb, float ratio) {
+    if (ratio > jb->max_correction) {
+        return jb->max_correction;
+    }
+    if (ratio < -jb->max_correction) {
+        return -jb->max_correction;
+    }
+    return ratio;
+}
+
+static void
+fill_silence(struct audiobuf_jitter *jb, uint8_t *to, uint32_t count) {
+    memset(to, 0, audiobuf_to_bytes(&jb->buf, count));
+}
+
+// Play what we have, pad with silence and prime again
+static uint32_t
+underrun(struct audiobuf_jitter *jb, uint8_t *to, uint32_t got,
+         uint32_t count) {
+    fill_silence(jb, to + audiobuf_to_bytes(&jb->buf, got), count - got);
+    counter_add(&jb->underruns, 1);
+    jb->playing = false;
+    return got;
+}
+
+// Map in_count input frames onto out_count output frames with nearest
+// neighbour, so the skipped or repeated frames are spread evenly over the
+// burst instead of clustering at its end
+static void
+stretch_copy(struct audiobuf_jitter *jb, const struct audiobuf_span spans[2],
+             uint32_t in_count, uint8_t *to, uint32_t out_count) {
+    size_t frame = jb->buf.sample_size;
+    uint32_t first = spans[0].samples;
+    for (uint32_t i = 0; i < out_count; ++i) {
+        uint32_t j = (uint32_t) ((uint64_t) i * in_count / out_count);
+        const uint8_t *src = j < first
+            ? (const uint8_t *) spans[0].data + j * frame
+            : (const uint8_t *) spans[1].data + (j - first) * frame;
+        memcpy(to + i * frame, src, frame);
+    }
+}
+
+uint32_t
+audiobuf_jitter_pull(struct audiobuf_jitter *jb, void *to_, uint32_t count) {
+    uint8_t *to = to_;
+    if (!count) {
+        return 0;
+    }
+    uint32_t fill = audiobuf_can_read(&jb->buf);
+
+    if (!jb->playing) {
+        // Priming: wait for the target level before starting
+        if (fill < jb->target) {
+            fill_silence(jb, to, count);
+            return 0;
+        }
+        jb->playing = true;
+        jb->avg_fill = (float) fill;
+        // keep the drift estimate, the clocks did not change
+        jb->correction_acc = 0;
+    }
+
+    if (fill > jb->max) {
+        // Far too late (e.g. after a stall): catch up at once
+        uint32_t excess = fill - jb->target;
+        audiobuf_read(&jb->buf, NULL, excess);
+        fill -= excess;
+        jb->avg_fill = (float) fill;
+        counter_add(&jb->overruns, 1);
+        counter_add(&jb->dropped, excess);
+    }
+
+    // Exponential average over ~AVERAGE_SECONDS, independent of burst size
+    float alpha = (float) count / (jb->sample_rate * AVERAGE_SECONDS);
+    if (alpha > 1.0f) {
+        alpha = 1.0f;
+    }
+    jb->avg_fill += alpha * ((float) fill - jb->avg_fill);
+    atomic_store_explicit(&jb->avg_fill_frames, (uint32_t) jb->avg_fill,
+                          memory_order_relaxed);
+
+    // Drift correction: positive skips frames (buffer too full), negative
+    // duplicates frames (buffer draining). The error is the distance from
+    // the target in seconds of audio; the drift estimate integrates it so
+    // that a constant clock mismatch is cancelled with no residual offset.
+    float error = (jb->avg_fill - (float) jb->target) / jb->sample_rate;
+    float elapsed = (float) count / jb->sample_rate;
+    jb->drift = clamp_correction(jb,
+            jb->drift + error * elapsed / DRIFT_SECONDS);
+    float ratio = clamp_correction(jb, error / SETTLE_SECONDS + jb->drift);
+    jb->correction_acc += ratio * count;
+    int32_t correction = (int32_t) jb->correction_acc;
+
+    // Input frames consumed for `count` output frames
+    uint32_t wanted = count;
+    if (correction < 0) {
+        uint32_t insert = (uint32_t) -correction;
+        wanted = insert < count ? count - insert : 1;
+    } else {
+        wanted = count + (uint32_t) correction;
+    }
+
+    struct audiobuf_span spans[2];
+    uint32_t got = audiobuf_acquire_read(&jb->buf, wanted, spans);
+    if (got == wanted) {
+        // only consume the correction once it is applied
+        jb->correction_acc -= (float) correction;
+    }
+    if (wanted == count || got < wanted) {
+        // No correction, or not enough data to apply it: plain copy
+        uint32_t n = got < count ? got : count;
+        if (n) {
+            audiobuf_read(&jb->buf, to, n);
+        }
+        if (n < count) {
+            return underrun(jb, to, n, count);
+        }
+        return count;
+    }
+    stretch_copy(jb, spans, wanted, to, count);
+    audiobuf_commit_read(&jb->buf, wanted);
+    if (wanted < count) {
+        counter_add(&jb->inserted, count - wanted);
+    } else {
+        counter_add(&jb->skipped, wanted - count);
+    }
+    return count;
+}
+
+void
+audiobuf_jitter_get_stats(struct audiobuf_jitter *jb,
+                          struct audiobuf_jitter_stats *stats) {
+    stats->underruns = atomic_load_explicit(&jb->underruns, memory_order_relaxed);
+    stats->overruns = atomic_load_explicit(&jb->overruns, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&jb->dropped, memory_order_relaxed);
+    stats->inserted = atomic_load_explicit(&jb->inserted, memory_order_relaxed);
+    stats->skipped = atomic_load_explicit(&jb->skipped, memory_order_relaxed);
+    stats->avg_fill = atomic_load_explicit(&jb->avg_fill_frames,
+                                           memory_order_relaxed);
+}
@@ -0,0 +1,107 @@
+#ifndef SC_AUDIOBUF_JITTER_H
+#define SC_AUDIOBUF_JITTER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "audiobuf.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Adaptive jitter buffer around struct audiobuf
+ *
+ * The producer pushes frames as they arrive from the network/decoder; the
+ * audio callback pulls exactly the number of frames it needs. The pull
+ * side:
+ *  - waits until target_ms is buffered before starting (and after each
+ *    underrun), outputting silence meanwhile;
+ *  - tracks the average fill level over about one second;
+ *  - compensates clock drift between producer and consumer by dropping or
+ *    duplicating single frames, at most max_correction_ppm of the stream.
+ *    The rate is steered by the distance from the target plus a slowly
+ *    learned drift estimate, so a constant drift settles on the target
+ *    instead of at an offset from it;
+ *  - drops everything above max_ms at once, e.g. after a stall.
+ *
+ * Frames are opaque (sample_size bytes), so any sample format works.
+ */
+struct audiobuf_jitter_config {
+    uint32_t sample_rate;        // frames per second
+    uint32_t target_ms;          // latency the fill level is steered to
+    uint32_t max_ms;             // 0: 3 * target_ms
+    uint32_t max_correction_ppm; // 0: 5000 (0.5%)
+};
+
+struct audiobuf_jitter_stats {
+    uint64_t underruns;  // pulls that ran out of data
+    uint64_t overruns;   // pushes that did not fit, or fill above max_ms
+    uint64_t dropped;    // frames discarded by overruns
+    uint64_t inserted;   // frames duplicated by drift compensation
+    uint64_t skipped;    // frames skipped by drift compensation
+    uint32_t avg_fill;   // average fill level, in frames
+};
+
+struct audiobuf_jitter {
+    struct audiobuf buf;
+    uint32_t sample_rate;
+    uint32_t target;  // in frames
+    uint32_t max;     // in frames
+    float max_correction;
+
+    // consumer state
+    bool playing;
+    float avg_fill;
+    float drift;          // learned producer/consumer rate mismatch
+    float correction_acc; // fractional frames to skip (> 0) or insert (< 0)
+
+    atomic_uint_fast64_t underruns;
+    atomic_uint_fast64_t overruns;
+    atomic_uint_fast64_t dropped;
+    atomic_uint_fast64_t inserted;
+    atomic_uint_fast64_t skipped;
+    atomic_uint_least32_t avg_fill_frames;
+};
+
+bool
+audiobuf_jitter_init(struct audiobuf_jitter *jb, size_t sample_size,
+                     const struct audiobuf_jitter_config *config);
+
+void
+audiobuf_jitter_destroy(struct audiobuf_jitter *jb);
+
+/**
+ * Producer side: queue frames
+ *
+ * @return the number of frames queued; the rest is dropped and counted as
+ *         an overrun
+ */
+uint32_t
+audiobuf_jitter_push(struct audiobuf_jitter *jb, const void *frames,
+                     uint32_t count);
+
+/**
+ * Consumer side: fill `to` with exactly `count` frames, padding with
+ * silence while priming or on underrun
+ *
+ * @return the number of frames that came from the stream (the rest is
+ *         silence)
+ */
+uint32_t
+audiobuf_jitter_pull(struct audiobuf_jitter *jb, void *to, uint32_t count);
+
+/**
+ * Snapshot of the counters, callable from any thread
+ */
+void
+audiobuf_jitter_get_stats(struct audiobuf_jitter *jb,
+                          struct audiobuf_jitter_stats *stats);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif
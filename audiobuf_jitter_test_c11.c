@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// 包含被测试的头文件
+#include "audiobuf_jitter.h"
+
+// --- 简单的断言宏，用于提供更清晰的输出 ---
+#define ASSERT(condition)                                           \
+    do {                                                            \
+        if (!(condition)) {                                         \
+            fprintf(stderr, "Assertion failed: %s, file %s, line %d\n", \
+                    #condition, __FILE__, __LINE__);                \
+            exit(1);                                                \
+        }                                                           \
+    } while (0)
+
+#define ASSERT_EQ(a, b) ASSERT((a) == (b))
+#define ASSERT_TRUE(a) ASSERT((a))
+
+#define RATE 48000
+#define BURST 480 // 10ms
+
+static struct audiobuf_jitter_config make_config(void) {
+    struct audiobuf_jitter_config config = {
+        .sample_rate = RATE,
+        .target_ms = 30,
+        .max_ms = 0,
+        .max_correction_ppm = 0,
+    };
+    return config;
+}
+
+// 每一帧是一个递增的 uint32_t 序号，方便检查顺序
+static uint32_t next_frame = 1;
+static void make_frames(uint32_t* frames, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        frames[i] = next_frame++;
+    }
+}
+
+// --- 测试实现 ---
+
+void test_priming_and_underrun() {
+    printf("Running: test_priming_and_underrun\n");
+    struct audiobuf_jitter jb;
+    struct audiobuf_jitter_config config = make_config();
+    ASSERT_TRUE(audiobuf_jitter_init(&jb, sizeof(uint32_t), &config));
+    ASSERT_EQ(jb.target, 1440u);
+
+    uint32_t in[BURST], out[BURST];
+    next_frame = 1;
+
+    // 未达到目标水位前输出静音，不计为 underrun
+    make_frames(in, BURST);
+    audiobuf_jitter_push(&jb, in, BURST);
+    ASSERT_EQ(audiobuf_jitter_pull(&jb, out, BURST), 0u);
+    ASSERT_EQ(out[0], 0u);
+
+    make_frames(in, BURST);
+    audiobuf_jitter_push(&jb, in, BURST);
+    make_frames(in, BURST);
+    audiobuf_jitter_push(&jb, in, BURST);
+    ASSERT_EQ(audiobuf_jitter_pull(&jb, out, BURST), (uint32_t)BURST);
+    ASSERT_EQ(out[0], 1u);
+
+    // 生产者停止：读完剩余数据后 underrun，用静音补齐
+    ASSERT_EQ(audiobuf_jitter_pull(&jb, out, BURST), (uint32_t)BURST);
+    ASSERT_EQ(audiobuf_jitter_pull(&jb, out, BURST), (uint32_t)BURST);
+    ASSERT_EQ(audiobuf_jitter_pull(&jb, out, BURST), 0u);
+    ASSERT_EQ(out[BURST - 1], 0u);
+
+    struct audiobuf_jitter_stats stats;
+    audiobuf_jitter_get_stats(&jb, &stats);
+    ASSERT_EQ(stats.underruns, 1u);
+    ASSERT_EQ(stats.overruns, 0u);
+
+    // underrun 后重新预缓冲
+    make_frames(in, BURST);
+    audiobuf_jitter_push(&jb, in, BURST);
+    ASSERT_EQ(audiobuf_jitter_pull(&jb, out, BURST), 0u);
+    audiobuf_jitter_get_stats(&jb, &stats);
+    ASSERT_EQ(stats.underruns, 1u);
+
+    audiobuf_jitter_destroy(&jb);
+}
+
+void test_overrun() {
+    printf("Running: test_overrun\n");
+    struct audiobuf_jitter jb;
+    struct audiobuf_jitter_config config = make_config();
+    ASSERT_TRUE(audiobuf_jitter_init(&jb, sizeof(uint32_t), &config));
+
+    uint32_t in[BURST], out[BURST];
+    next_frame = 1;
+    uint32_t capacity = audiobuf_capacity(&jb.buf);
+    uint32_t pushed = 0;
+    while (pushed < capacity + BURST) {
+        make_frames(in, BURST);
+        pushed += audiobuf_jitter_push(&jb, in, BURST);
+        if (pushed >= capacity) {
+            make_frames(in, BURST);
+            audiobuf_jitter_push(&jb, in, BURST);
+            break;
+        }
+    }
+
+    struct audiobuf_jitter_stats stats;
+    audiobuf_jitter_get_stats(&jb, &stats);
+    ASSERT_TRUE(stats.overruns >= 1);
+    ASSERT_TRUE(stats.dropped >= BURST);
+
+    // 超过 max_ms 的积压在下一次读取时一次性丢弃，只保留目标水位
+    uint64_t overruns = stats.overruns;
+    ASSERT_EQ(audiobuf_jitter_pull(&jb, out, BURST), (uint32_t)BURST);
+    audiobuf_jitter_get_stats(&jb, &stats);
+    ASSERT_EQ(stats.overruns, overruns + 1);
+    ASSERT_TRUE(audiobuf_can_read(&jb.buf) <= jb.target);
+    // 丢掉的是最旧的数据，输出跳到较新的帧
+    ASSERT_TRUE(out[0] > capacity - jb.target - BURST);
+
+    audiobuf_jitter_destroy(&jb);
+}
+
+// 模拟生产者时钟比消费者快/慢 0.3%，运行 120 秒：水位应稳定在目标附近，不出现 overrun/underrun
+static void run_drift(double producer_ratio) {
+    struct audiobuf_jitter jb;
+    struct audiobuf_jitter_config config = make_config();
+    ASSERT_TRUE(audiobuf_jitter_init(&jb, sizeof(uint32_t), &config));
+
+    uint32_t in[BURST * 2], out[BURST];
+    next_frame = 1;
+    double produced = 0;
+    uint32_t last = 0;
+    for (int tick = 0; tick < 120 * 100; ++tick) {
+        // 每 10ms 生产者写入 BURST * ratio 帧（累计小数部分），消费者读取 BURST 帧
+        produced += BURST * producer_ratio;
+        uint32_t n = (uint32_t)produced;
+        produced -= n;
+        make_frames(in, n);
+        audiobuf_jitter_push(&jb, in, n);
+
+        uint32_t got = audiobuf_jitter_pull(&jb, out, BURST);
+        // 输出帧序号单调不减（插入的帧是重复），跳帧只跳过少量帧
+        for (uint32_t i = 0; i < got; ++i) {
+            ASSERT_TRUE(out[i] >= last);
+            ASSERT_TRUE(last == 0 || out[i] - last <= 2);
+            last = out[i];
+        }
+    }
+
+    struct audiobuf_jitter_stats stats;
+    audiobuf_jitter_get_stats(&jb, &stats);
+    printf("  ratio %.4f: avg_fill %u (target %u), inserted %llu, skipped %llu\n",
+           producer_ratio, stats.avg_fill, jb.target,
+           (unsigned long long)stats.inserted, (unsigned long long)stats.skipped);
+    ASSERT_EQ(stats.overruns, 0u);
+    ASSERT_EQ(stats.underruns, 0u);
+    // 漂移估计收敛后平均水位回到目标，误差不超过 2ms
+    ASSERT_TRUE(stats.avg_fill + RATE / 500 >= jb.target);
+    ASSERT_TRUE(stats.avg_fill <= jb.target + RATE / 500);
+    if (producer_ratio > 1.0) {
+        ASSERT_TRUE(stats.skipped > 0);
+    } else {
+        ASSERT_TRUE(stats.inserted > 0);
+    }
+    audiobuf_jitter_destroy(&jb);
+}
+
+void test_drift_compensation() {
+    printf("Running: test_drift_compensation\n");
+    run_drift(1.003);
+    run_drift(0.997);
+    // 接近 max_correction_ppm (0.5%) 的漂移同样收敛到目标
+    run_drift(1.0045);
+    run_drift(0.9955);
+}
+
+
+// --- 主函数 ---
+int main() {
+    printf("--- Starting audiobuf_jitter C11 tests ---\n");
+
+    test_priming_and_underrun();
+    test_overrun();
+    test_drift_compensation();
+
+    printf("--- All audiobuf_jitter C11 tests passed! ---\n");
+    return 0;
+}
@@ -55,6 +55,9 @@ void test_read_from_empty();
 void test_wrap_around();
 void test_write_silence();
 void test_spsc_concurrency();
+void test_wait_can_read();
+void test_pow2_mode();
+void test_acquire_commit_read();
 
 // --- 测试实现 ---
 
@@ -290,6 +293,117 @@ void test_spsc_concurrency() {
     audiobuf_destroy(&buf);
 }
 
+// --- audiobuf_wait_can_read 测试 ---
+void* delayed_writer_thread_func(void* args_ptr) {
+    struct audiobuf* buf = args_ptr;
+    int16_t samples[32] = { 0 };
+    for (int i = 0; i < 4; ++i) {
+        cross_platform_sleep_ms(5);
+        audiobuf_write(buf, samples, 32);
+    }
+    return NULL;
+}
+
+void test_wait_can_read() {
+    printf("Running: test_wait_can_read\n");
+    struct audiobuf buf;
+    audiobuf_init(&buf, sizeof(int16_t), 1024);
+
+    // 没有数据时超时返回
+    ASSERT_EQ(audiobuf_wait_can_read(&buf, 1, 10), 0);
+
+    // 写者分四次写入，读者一直睡到凑够 128 个样本
+    pthread_t writer_tid;
+    pthread_create(&writer_tid, NULL, delayed_writer_thread_func, &buf);
+    uint32_t can_read = audiobuf_wait_can_read(&buf, 128, 10000);
+    ASSERT_EQ(can_read, 128);
+    pthread_join(writer_tid, NULL);
+
+    // 已经有足够数据时立即返回
+    ASSERT_EQ(audiobuf_wait_can_read(&buf, 64, -1), 128);
+
+    audiobuf_destroy(&buf);
+}
+
+// --- 2 的幂模式测试 ---
+void test_pow2_mode() {
+    printf("Running: test_pow2_mode\n");
+    struct audiobuf buf;
+    ASSERT_TRUE(audiobuf_init_pow2(&buf, sizeof(int16_t), 1000));
+    ASSERT_EQ(buf.alloc_size, 1024);
+    ASSERT_EQ(buf.mask, 1023);
+    // 游标自由递增，所有槽位都可用
+    ASSERT_EQ(audiobuf_capacity(&buf), 1024);
+
+    int16_t data[1024];
+    for (int i = 0; i < 1024; ++i) {
+        data[i] = (int16_t)i;
+    }
+    ASSERT_EQ(audiobuf_write(&buf, data, 1024), 1024);
+    ASSERT_EQ(audiobuf_write(&buf, data, 1), 0);
+    ASSERT_EQ(audiobuf_can_read(&buf), 1024);
+
+    int16_t out[1024];
+    ASSERT_EQ(audiobuf_read(&buf, out, 1024), 1024);
+    ASSERT_EQ(memcmp(data, out, sizeof(data)), 0);
+
+    // 把游标放到 32 位回绕点附近，验证计数器溢出后仍然正确
+    atomic_store(&buf.head, UINT32_MAX - 10);
+    atomic_store(&buf.tail, UINT32_MAX - 10);
+    ASSERT_EQ(audiobuf_write(&buf, data, 100), 100);
+    ASSERT_EQ(audiobuf_can_read(&buf), 100);
+    ASSERT_EQ(audiobuf_write_silence(&buf, 24), 24);
+    ASSERT_EQ(audiobuf_read(&buf, out, 124), 124);
+    ASSERT_EQ(memcmp(data, out, 100 * sizeof(int16_t)), 0);
+    ASSERT_EQ(out[100], 0);
+    ASSERT_EQ(audiobuf_can_read(&buf), 0);
+    ASSERT_EQ(atomic_load(&buf.tail), 113);
+
+    audiobuf_destroy(&buf);
+}
+
+// --- 零拷贝读取测试 ---
+void test_acquire_commit_read() {
+    printf("Running: test_acquire_commit_read\n");
+    // 两种模式下行为一致
+    for (int pow2 = 0; pow2 < 2; ++pow2) {
+        struct audiobuf buf;
+        ASSERT_TRUE(pow2 ? audiobuf_init_pow2(&buf, sizeof(int16_t), 64)
+                         : audiobuf_init(&buf, sizeof(int16_t), 64));
+        uint32_t cap = audiobuf_capacity(&buf);
+
+        int16_t data[64];
+        for (int i = 0; i < 64; ++i) {
+            data[i] = (int16_t)(i + 1);
+        }
+        // 读写游标移动到末尾附近，让数据跨越边界
+        ASSERT_EQ(audiobuf_write(&buf, data, cap - 10), cap - 10);
+        ASSERT_EQ(audiobuf_read(&buf, NULL, cap - 10), cap - 10);
+        ASSERT_EQ(audiobuf_write(&buf, data, 30), 30);
+
+        struct audiobuf_span spans[2];
+        ASSERT_EQ(audiobuf_acquire_read(&buf, 64, spans), 30);
+        ASSERT_EQ(spans[0].samples + spans[1].samples, 30);
+        ASSERT_TRUE(spans[1].samples > 0);
+        ASSERT_EQ(spans[1].data, (void*)buf.data);
+        ASSERT_EQ(memcmp(spans[0].data, data, spans[0].samples * sizeof(int16_t)), 0);
+        ASSERT_EQ(memcmp(spans[1].data, data + spans[0].samples,
+                         spans[1].samples * sizeof(int16_t)), 0);
+
+        // 提交前数据仍然可读
+        ASSERT_EQ(audiobuf_can_read(&buf), 30);
+        audiobuf_commit_read(&buf, 20);
+        ASSERT_EQ(audiobuf_can_read(&buf), 10);
+
+        ASSERT_EQ(audiobuf_acquire_read(&buf, 4, spans), 4);
+        ASSERT_EQ(((int16_t*)spans[0].data)[0], 21);
+        audiobuf_commit_read(&buf, 4);
+        ASSERT_EQ(audiobuf_can_read(&buf), 6);
+
+        audiobuf_destroy(&buf);
+    }
+}
+
 
 // --- 主函数 ---
 int main() {
@@ -303,6 +417,9 @@ int main() {
     test_wrap_around();
     test_write_silence();
     test_spsc_concurrency();
+    test_wait_can_read();
+    test_pow2_mode();
+    test_acquire_commit_read();
 
     printf("--- All audiobuf C11 tests passed! ---\n");
     return 0;
@@ -0,0 +1,455 @@
+#ifndef CIRCULARBUF_DYNAMIC_HPP
+#define CIRCULARBUF_DYNAMIC_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+
+#include <string.h>
+#include <assert.h>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#if defined(_MSC_VER)
+#pragma comment(lib, "Synchronization.lib") // WaitOnAddress / WakeByAddressAll
+#endif
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+#endif
+
+namespace circular_buf_detail {
+
+	// Wait while *addr == expected, at most `timeout`. Returns false on timeout.
+	// Spurious wakeups are possible, callers re-check their condition.
+	inline bool FutexWait(std::atomic<uint32_t> *addr, uint32_t expected, std::chrono::nanoseconds timeout)
+	{
+		if(timeout <= std::chrono::nanoseconds::zero())
+			return false;
+#if defined(__linux__)
+		struct timespec ts;
+		ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+		ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+		long rc = syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+		return rc == 0 || errno != ETIMEDOUT;
+#elif defined(_WIN32)
+		DWORD ms = static_cast<DWORD>(std::chrono::ceil<std::chrono::milliseconds>(timeout).count());
+		return WaitOnAddress(reinterpret_cast<volatile VOID *>(addr), &expected, sizeof(expected), ms) != FALSE;
+#else
+		// No address-wait primitive: short sleep and let the caller re-check
+		(void)addr;
+		(void)expected;
+		std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(1)));
+		return true;
+#endif
+	}
+
+	inline void FutexWakeAll(std::atomic<uint32_t> *addr)
+	{
+#if defined(__linux__)
+		syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+		WakeByAddressAll(reinterpret_cast<PVOID>(addr));
+#else
+		(void)addr;
+#endif
+	}
+
+} // namespace circular_buf_detail
+
+/**
+ * Runtime-sized single-producer/single-consumer chunk ring, the dynamic counterpart of
+ * CircularBuffer<ChunksCount, ChunkSize> with the same Push/Pop and zero-copy chunk API.
+ *
+ * - Storage comes from mmap (VirtualAlloc on Windows). With Options::huge_pages it first tries
+ *   MAP_HUGETLB and falls back to madvise(MADV_HUGEPAGE); with Options::lock_memory the pages
+ *   are mlock()ed so the audio/capture path never page-faults. Check UsesHugePages()/IsLocked()
+ *   for what was actually granted.
+ * - Chunks are used strictly in ring order, so instead of free/full queues the producer and
+ *   consumer only share two free-running 32-bit chunk counters. Their difference is the number
+ *   of chunks in use; the slot each side works on is tracked separately, because 2^32 is not a
+ *   multiple of a non-power-of-two chunk count and counter % chunks_count would skip at the wrap.
+ * - PushBlocking/PopBlocking wait on those counters with a futex (WaitOnAddress on Windows)
+ *   and a timeout. A side only issues the wake syscall when the other side has announced that
+ *   it is sleeping, so the non-blocking fast path has no syscalls.
+ *
+ * As with CircularBuffer, Push() publishes a chunk only once it is full; CommitWriteChunk()
+ * publishes immediately.
+ */
+class DynamicCircularBuffer
+{
+	public:
+		struct Options
+		{
+			bool huge_pages = false;  // back the buffer with huge pages if possible
+			bool lock_memory = false; // mlock the buffer
+		};
+
+		DynamicCircularBuffer(size_t chunks_count, size_t chunk_size)
+			: DynamicCircularBuffer(chunks_count, chunk_size, Options()) {}
+
+		/**
+		 * @throws std::bad_alloc if the buffer cannot be mapped
+		 */
+		DynamicCircularBuffer(size_t chunks_count, size_t chunk_size, const Options &options)
+			: chunks_count(chunks_count), chunk_size(chunk_size)
+		{
+			assert(chunks_count > 0 && chunks_count < (1u << 31));
+			assert(chunk_size > 0);
+			chunk_used.reset(new size_t[chunks_count]());
+			Map(options);
+			Flush();
+		}
+
+		~DynamicCircularBuffer()
+		{
+			Unmap();
+		}
+
+		DynamicCircularBuffer(const DynamicCircularBuffer &) = delete;
+		DynamicCircularBuffer &operator=(const DynamicCircularBuffer &) = delete;
+
+		size_t ChunksCount() const { return chunks_count; }
+		size_t ChunkSize() const { return chunk_size; }
+		bool UsesHugePages() const { return huge_pages; }
+		bool IsLocked() const { return locked; }
+
+		/**
+		 * Reset the entire Buffer.
+		 * WARNING: Not thread-safe at all! Call only when no producer and consumer is running.
+		 * @param start_counter initial value of both chunk counters; any value is valid, a value
+		 *        close to UINT32_MAX exercises the counter wrap-around
+		 */
+		void Flush(uint32_t start_counter = 0)
+		{
+			written.store(start_counter, std::memory_order_relaxed);
+			released.store(start_counter, std::memory_order_relaxed);
+			push_slot = 0;
+			pop_slot = 0;
+			push_chunk = nullptr;
+			push_chunk_size = 0;
+			pop_chunk = nullptr;
+			pop_chunk_size = 0;
+			pop_chunk_offset = 0;
+		}
+
+		/**
+		 * @return bytes that were pushed
+		 */
+		size_t Push(const uint8_t *buf, size_t buf_size)
+		{
+			size_t pushed = 0;
+			while(pushed < buf_size)
+			{
+				if(!push_chunk && !AcquirePushChunk())
+					return pushed;
+
+				size_t to_push = buf_size - pushed;
+				size_t remaining_space = chunk_size - push_chunk_size;
+				if(to_push > remaining_space)
+					to_push = remaining_space;
+				memcpy(push_chunk + push_chunk_size, buf + pushed, to_push);
+				pushed += to_push;
+				push_chunk_size += to_push;
+
+				if(push_chunk_size == chunk_size)
+					PublishPushChunk();
+			}
+			return pushed;
+		}
+
+		/**
+		 * @return bytes that were popped
+		 */
+		size_t Pop(uint8_t *buf, size_t buf_size)
+		{
+			size_t popped = 0;
+			while(popped < buf_size)
+			{
+				if(!pop_chunk && !AcquirePopChunk())
+					return popped;
+
+				size_t to_pop = buf_size - popped;
+				if(to_pop > pop_chunk_size)
+					to_pop = pop_chunk_size;
+				memcpy(buf + popped, pop_chunk + pop_chunk_offset, to_pop);
+				popped += to_pop;
+				pop_chunk_size -= to_pop;
+				pop_chunk_offset += to_pop;
+
+				if(pop_chunk_size == 0)
+					ReleasePopChunk();
+			}
+			return popped;
+		}
+
+		/**
+		 * Push all of buf, sleeping while no chunk is free, for at most `timeout` in total.
+		 * @return bytes that were pushed (less than buf_size only on timeout)
+		 */
+		size_t PushBlocking(const uint8_t *buf, size_t buf_size, std::chrono::nanoseconds timeout)
+		{
+			auto deadline = std::chrono::steady_clock::now() + timeout;
+			size_t pushed = Push(buf, buf_size);
+			while(pushed < buf_size)
+			{
+				// Push() stopped because every chunk is in use: wait for the consumer to release one
+				if(!WaitForChange(released, writer_waiting, [this]() { return HasFreeChunk(); }, deadline))
+					break;
+				pushed += Push(buf + pushed, buf_size - pushed);
+			}
+			return pushed;
+		}
+
+		/**
+		 * Pop up to buf_size bytes, sleeping while no published chunk is available.
+		 * Returns as soon as at least one byte was popped, or after `timeout`.
+		 * @return bytes that were popped (0 on timeout)
+		 */
+		size_t PopBlocking(uint8_t *buf, size_t buf_size, std::chrono::nanoseconds timeout)
+		{
+			auto deadline = std::chrono::steady_clock::now() + timeout;
+			size_t popped = Pop(buf, buf_size);
+			while(popped == 0 && buf_size > 0)
+			{
+				if(!WaitForChange(written, reader_waiting, [this]() { return HasFullChunk(); }, deadline))
+					break;
+				popped = Pop(buf, buf_size);
+			}
+			return popped;
+		}
+
+		/**
+		 * Zero-copy write, see CircularBuffer::AcquireWriteChunk().
+		 */
+		uint8_t *AcquireWriteChunk(size_t *space = nullptr)
+		{
+			if(!push_chunk && !AcquirePushChunk())
+			{
+				if(space)
+					*space = 0;
+				return nullptr;
+			}
+			if(space)
+				*space = chunk_size - push_chunk_size;
+			return push_chunk + push_chunk_size;
+		}
+
+		/**
+		 * Publish `size` bytes written through AcquireWriteChunk(), see CircularBuffer::CommitWriteChunk().
+		 */
+		void CommitWriteChunk(size_t size)
+		{
+			assert(push_chunk);
+			assert(size <= chunk_size - push_chunk_size);
+			if(size == 0)
+				return;
+			push_chunk_size += size;
+			PublishPushChunk();
+		}
+
+		/**
+		 * Zero-copy read, see CircularBuffer::AcquireReadChunk().
+		 */
+		uint8_t *AcquireReadChunk(size_t *size)
+		{
+			if(!pop_chunk && !AcquirePopChunk())
+			{
+				*size = 0;
+				return nullptr;
+			}
+			*size = pop_chunk_size;
+			return pop_chunk + pop_chunk_offset;
+		}
+
+		void ReleaseReadChunk()
+		{
+			assert(pop_chunk);
+			ReleasePopChunk();
+		}
+
+	private:
+		uint8_t *Chunk(size_t slot) const
+		{
+			return buffer + slot * chunk_size;
+		}
+
+		// producer side
+		bool HasFreeChunk() const
+		{
+			return written.load(std::memory_order_relaxed) - released.load(std::memory_order_acquire) < chunks_count;
+		}
+
+		bool AcquirePushChunk()
+		{
+			if(!HasFreeChunk())
+				return false;
+			push_chunk = Chunk(push_slot);
+			push_chunk_size = 0;
+			return true;
+		}
+
+		void PublishPushChunk()
+		{
+			uint32_t w = written.load(std::memory_order_relaxed);
+			chunk_used[push_slot] = push_chunk_size;
+			push_slot = push_slot + 1 == chunks_count ? 0 : push_slot + 1;
+			written.store(w + 1, std::memory_order_release);
+			push_chunk = nullptr;
+			WakeIfWaiting(written, reader_waiting);
+		}
+
+		// consumer side
+		bool HasFullChunk() const
+		{
+			return written.load(std::memory_order_acquire) != released.load(std::memory_order_relaxed);
+		}
+
+		bool AcquirePopChunk()
+		{
+			if(!HasFullChunk())
+				return false;
+			pop_chunk = Chunk(pop_slot);
+			pop_chunk_size = chunk_used[pop_slot];
+			pop_chunk_offset = 0;
+			return true;
+		}
+
+		void ReleasePopChunk()
+		{
+			pop_slot = pop_slot + 1 == chunks_count ? 0 : pop_slot + 1;
+			released.store(released.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			pop_chunk = nullptr;
+			WakeIfWaiting(released, writer_waiting);
+		}
+
+		// Only wake when the other side announced it is (about to be) sleeping.
+		// The fence pairs with the one in WaitForChange so that either the waiter sees the
+		// new counter value or we see its waiting flag.
+		static void WakeIfWaiting(std::atomic<uint32_t> &counter, std::atomic<uint32_t> &waiting)
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(waiting.load(std::memory_order_relaxed))
+				circular_buf_detail::FutexWakeAll(&counter);
+		}
+
+		template<typename Ready>
+		static bool WaitForChange(std::atomic<uint32_t> &counter, std::atomic<uint32_t> &waiting, Ready &&ready,
+			std::chrono::steady_clock::time_point deadline)
+		{
+			for(;;)
+			{
+				uint32_t seen = counter.load(std::memory_order_acquire);
+				waiting.store(1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if(ready())
+				{
+					waiting.store(0, std::memory_order_relaxed);
+					return true;
+				}
+				auto now = std::chrono::steady_clock::now();
+				bool woke = now < deadline && circular_buf_detail::FutexWait(&counter, seen, deadline - now);
+				waiting.store(0, std::memory_order_relaxed);
+				if(ready())
+					return true;
+				if(!woke && std::chrono::steady_clock::now() >= deadline)
+					return false;
+			}
+		}
+
+		void Map(const Options &options)
+		{
+			mapped_size = chunks_count * chunk_size;
+#if defined(_WIN32)
+			buffer = static_cast<uint8_t *>(VirtualAlloc(nullptr, mapped_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+			if(!buffer)
+				throw std::bad_alloc();
+			if(options.lock_memory)
+				locked = VirtualLock(buffer, mapped_size) != FALSE;
+#else
+			void *p = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+			if(options.huge_pages)
+			{
+				const size_t huge = 2 * 1024 * 1024;
+				size_t size = (mapped_size + huge - 1) / huge * huge;
+				p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+				if(p != MAP_FAILED)
+				{
+					mapped_size = size;
+					huge_pages = true;
+				}
+			}
+#endif
+			if(p == MAP_FAILED)
+			{
+				p = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if(p == MAP_FAILED)
+					throw std::bad_alloc();
+#if defined(MADV_HUGEPAGE)
+				// transparent huge pages as the fallback when no hugetlbfs pages are reserved
+				if(options.huge_pages)
+					huge_pages = madvise(p, mapped_size, MADV_HUGEPAGE) == 0;
+#endif
+			}
+			buffer = static_cast<uint8_t *>(p);
+			if(options.lock_memory)
+				locked = mlock(buffer, mapped_size) == 0;
+#endif
+		}
+
+		void Unmap()
+		{
+			if(!buffer)
+				return;
+#if defined(_WIN32)
+			if(locked)
+				VirtualUnlock(buffer, mapped_size);
+			VirtualFree(buffer, 0, MEM_RELEASE);
+#else
+			if(locked)
+				munlock(buffer, mapped_size);
+			munmap(buffer, mapped_size);
+#endif
+			buffer = nullptr;
+		}
+
+		const size_t chunks_count;
+		const size_t chunk_size;
+		uint8_t *buffer = nullptr;
+		size_t mapped_size = 0;
+		bool huge_pages = false;
+		bool locked = false;
+		std::unique_ptr<size_t[]> chunk_used;
+
+		// producer-owned state
+		alignas(64) std::atomic<uint32_t> written{ 0 }; // chunks published (free-running)
+		std::atomic<uint32_t> writer_waiting{ 0 };
+		uint8_t *push_chunk = nullptr;
+		size_t push_chunk_size = 0;
+		size_t push_slot = 0; // chunk index of `written`
+
+		// consumer-owned state
+		alignas(64) std::atomic<uint32_t> released{ 0 }; // chunks handed back (free-running)
+		std::atomic<uint32_t> reader_waiting{ 0 };
+		uint8_t *pop_chunk = nullptr;
+		size_t pop_chunk_size = 0;
+		size_t pop_chunk_offset = 0;
+		size_t pop_slot = 0; // chunk index of `released`
+};
+
+#endif // CIRCULARBUF_DYNAMIC_HPP
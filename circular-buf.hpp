@@ -25,7 +25,47 @@ class CircularBuffer
 		size_t push_chunk_size; // written bytes from the start of the chunk
 
 		uint8_t *pop_chunk;
-		size_t pop_chunk_size; // remaining bytes until the end of the chunk
+		size_t pop_chunk_size; // remaining bytes until the end of the chunk's data
+		size_t pop_chunk_offset; // read position from the start of the chunk
+
+		// number of valid bytes in each published chunk. Written by the producer before
+		// the chunk is pushed to full_queue (release), read by the consumer after popping it.
+		size_t chunk_used[ChunksCount];
+
+		size_t ChunkIndex(const uint8_t *chunk) const
+		{
+			return static_cast<size_t>(chunk - buffer) / ChunkSize;
+		}
+
+		// Hand the current push chunk with `used` valid bytes over to the consumer
+		void PublishPushChunk(size_t used)
+		{
+			chunk_used[ChunkIndex(push_chunk)] = used;
+			bool success = full_queue.push(push_chunk);
+			assert(success); // We should have made the queues big enough
+			(void)success;
+			push_chunk = nullptr;
+		}
+
+		// Take the next published chunk, returns false if there is none
+		bool FetchPopChunk()
+		{
+			if(!full_queue.pop(pop_chunk))
+				pop_chunk = nullptr;
+			if(!pop_chunk)
+				return false;
+			pop_chunk_size = chunk_used[ChunkIndex(pop_chunk)];
+			pop_chunk_offset = 0;
+			return true;
+		}
+
+		void ReleasePopChunk()
+		{
+			bool success = free_queue.push(pop_chunk);
+			assert(success);// We should have made the queues big enough
+			(void)success;
+			pop_chunk = nullptr;
+		}
  
 
 		void FlushChunks()
@@ -38,6 +78,7 @@ class CircularBuffer
 
 			pop_chunk = nullptr;
 			pop_chunk_size = 0;
+			pop_chunk_offset = 0;
 		}
 
 	public:
@@ -90,11 +131,7 @@ class CircularBuffer
 				push_chunk_size += to_push;
 
 				if(push_chunk_size == ChunkSize)
-				{
-					bool success = full_queue.push(push_chunk);
-					assert(success); // We should have made the queues big enough
-					push_chunk = nullptr;
-				}
+					PublishPushChunk(ChunkSize);
 			}
 
 		 
@@ -109,33 +146,92 @@ class CircularBuffer
 			size_t popped = 0;
 			while(popped < buf_size)
 			{
-				if(!pop_chunk)
-				{
-					if(!full_queue.pop(pop_chunk))
-						pop_chunk = nullptr;
-					if(!pop_chunk)
-						return popped;
-					pop_chunk_size = ChunkSize;
-				}
+				if(!pop_chunk && !FetchPopChunk())
+					return popped;
 
 				size_t to_pop = buf_size - popped;
 				if(to_pop > pop_chunk_size)
 					to_pop = pop_chunk_size;
-				memcpy(buf + popped, pop_chunk + (ChunkSize - pop_chunk_size), to_pop);
+				memcpy(buf + popped, pop_chunk + pop_chunk_offset, to_pop);
 				popped += to_pop;
 				pop_chunk_size -= to_pop;
+				pop_chunk_offset += to_pop;
 
 				if(pop_chunk_size == 0)
-				{
-					bool success = free_queue.push(pop_chunk);
-					assert(success);// We should have made the queues big enough
-					pop_chunk = nullptr;
-				}
+					ReleasePopChunk();
 			}
 
 			 
 			return popped;
 		}
+		/**
+		 * Zero-copy write: get a pointer into the ring where the producer can write directly
+		 * (e.g. recv() into it). Continues the chunk partially filled by Push(), if any.
+		 * Producer thread only.
+		 * @param space if not null, receives the number of writable bytes at the returned pointer
+		 * @return write pointer, or nullptr if no free chunk is available
+		 */
+		uint8_t *AcquireWriteChunk(size_t *space = nullptr)
+		{
+			if(!push_chunk)
+			{
+				if(!free_queue.pop(push_chunk))
+					push_chunk = nullptr;
+				if(!push_chunk)
+				{
+					if(space)
+						*space = 0;
+					return nullptr;
+				}
+				push_chunk_size = 0;
+			}
+			if(space)
+				*space = ChunkSize - push_chunk_size;
+			return push_chunk + push_chunk_size;
+		}
+
+		/**
+		 * Publish `size` bytes written at the pointer returned by AcquireWriteChunk().
+		 * The chunk becomes visible to the consumer immediately, even if it is not full,
+		 * so one acquire/commit pair maps to one chunk on the read side.
+		 * Committing 0 bytes keeps the chunk acquired.
+		 */
+		void CommitWriteChunk(size_t size)
+		{
+			assert(push_chunk);
+			assert(size <= ChunkSize - push_chunk_size);
+			if(size == 0)
+				return;
+			push_chunk_size += size;
+			PublishPushChunk(push_chunk_size);
+		}
+
+		/**
+		 * Zero-copy read: get a pointer to the unread data of the next chunk (or of the chunk
+		 * partially consumed by Pop()). The data stays valid until ReleaseReadChunk().
+		 * Consumer thread only.
+		 * @param size receives the number of readable bytes
+		 * @return read pointer, or nullptr if no data is available
+		 */
+		uint8_t *AcquireReadChunk(size_t *size)
+		{
+			if(!pop_chunk && !FetchPopChunk())
+			{
+				*size = 0;
+				return nullptr;
+			}
+			*size = pop_chunk_size;
+			return pop_chunk + pop_chunk_offset;
+		}
+
+		/**
+		 * Return the chunk obtained by AcquireReadChunk() to the producer.
+		 */
+		void ReleaseReadChunk()
+		{
+			assert(pop_chunk);
+			ReleasePopChunk();
+		}
  
 };
 
@@ -19,24 +19,54 @@
 #define CIRCULARFIFO_AQUIRE_RELEASE_H_
 
 #include <atomic>
+#include <bit>
 #include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
 namespace memory_relaxed_aquire_release {
+
+// Elements are constructed in place in raw aligned storage, so Element does not
+// need to be default constructible or copyable (e.g. std::unique_ptr<Frame>).
+// push/emplace construct into the slot, pop moves out and destroys it.
 template<typename Element, size_t Size> 
 class CircularFifo{
 public:
   enum { Capacity = Size+1 };
 
   CircularFifo() : _tail(0), _head(0){}   
-  virtual ~CircularFifo() {}
+  virtual ~CircularFifo() { destroyAll(); }
+
+  CircularFifo(const CircularFifo&) = delete;
+  CircularFifo& operator=(const CircularFifo&) = delete;
+
+  bool push(const Element& item) { return emplace(item); }
+  bool push(Element&& item) { return emplace(std::move(item)); }
+  template<typename... Args>
+  bool emplace(Args&&... args);
 
-  bool push(const Element& item); // pushByMOve?
   bool pop(Element& item);
+  std::optional<Element> pop();
+
+  // Push up to n elements constructed from *first, *(first+1), ... (wrap the
+  // iterator in std::make_move_iterator to move). The tail index is published
+  // once for the whole batch. Returns the number of elements pushed.
+  template<typename InputIt>
+  size_t push_n(InputIt first, size_t n);
+
+  // Pop up to n elements into *out++, publishing the head index once.
+  // Returns the number of elements popped.
+  template<typename OutputIt>
+  size_t pop_n(OutputIt out, size_t n);
 
   bool wasEmpty() const;
   bool wasFull() const;
   bool isLockFree() const;
 
+  // WARNING: not thread-safe, call only when no producer and consumer is running.
   void clear() {
+    destroyAll();
     _head.store(0, std::memory_order_release);
     _tail.store(0, std::memory_order_release);
   }
@@ -45,19 +75,27 @@ public:
 private:
   size_t increment(size_t idx) const; 
 
+  Element* slot(size_t idx) { return std::launder(reinterpret_cast<Element*>(_array[idx])); }
+
+  void destroyAll() {
+    for(size_t i = _head.load(std::memory_order_relaxed); i != _tail.load(std::memory_order_relaxed); i = increment(i))
+      std::destroy_at(slot(i));
+  }
+
   std::atomic <size_t>  _tail;  // tail(input) index
-  Element    _array[Capacity];
+  alignas(Element) unsigned char _array[Capacity][sizeof(Element)];
   std::atomic<size_t>   _head; // head(output) index
 };
 
 template<typename Element, size_t Size>
-bool CircularFifo<Element, Size>::push(const Element& item)
+template<typename... Args>
+bool CircularFifo<Element, Size>::emplace(Args&&... args)
 {	
   const auto current_tail = _tail.load(std::memory_order_relaxed); 
   const auto next_tail = increment(current_tail); 
   if(next_tail != _head.load(std::memory_order_acquire))                           
   {	
-    _array[current_tail] = item;
+    ::new (static_cast<void*>(_array[current_tail])) Element(std::forward<Args>(args)...);
     _tail.store(next_tail, std::memory_order_release); 
     return true;
   }
@@ -76,11 +114,88 @@ bool CircularFifo<Element, Size>::pop(Element& item)
   if(current_head == _tail.load(std::memory_order_acquire)) 
     return false; // empty queue
 
-  item = _array[current_head]; 
+  Element* e = slot(current_head);
+  item = std::move(*e);
+  std::destroy_at(e);
   _head.store(increment(current_head), std::memory_order_release); 
   return true;
 }
 
+template<typename Element, size_t Size>
+std::optional<Element> CircularFifo<Element, Size>::pop()
+{
+  const auto current_head = _head.load(std::memory_order_relaxed);  
+  if(current_head == _tail.load(std::memory_order_acquire)) 
+    return std::nullopt; // empty queue
+
+  Element* e = slot(current_head);
+  std::optional<Element> item(std::move(*e));
+  std::destroy_at(e);
+  _head.store(increment(current_head), std::memory_order_release); 
+  return item;
+}
+
+template<typename Element, size_t Size>
+template<typename InputIt>
+size_t CircularFifo<Element, Size>::push_n(InputIt first, size_t n)
+{
+  const auto current_tail = _tail.load(std::memory_order_relaxed);
+  const auto head = _head.load(std::memory_order_acquire);
+  const size_t used = (current_tail + Capacity - head) % Capacity;
+  const size_t count = n < Size - used ? n : Size - used;
+
+  size_t idx = current_tail;
+  try
+  {
+    for(size_t i = 0; i < count; ++i, ++first)
+    {
+      ::new (static_cast<void*>(_array[idx])) Element(*first);
+      idx = increment(idx);
+    }
+  }
+  catch(...)
+  {
+    // publish the elements constructed so far, the next push starts after them
+    _tail.store(idx, std::memory_order_release);
+    throw;
+  }
+  if(count)
+    _tail.store(idx, std::memory_order_release);
+  return count;
+}
+
+template<typename Element, size_t Size>
+template<typename OutputIt>
+size_t CircularFifo<Element, Size>::pop_n(OutputIt out, size_t n)
+{
+  const auto current_head = _head.load(std::memory_order_relaxed);
+  const auto tail = _tail.load(std::memory_order_acquire);
+  const size_t available = (tail + Capacity - current_head) % Capacity;
+  const size_t count = n < available ? n : available;
+
+  size_t idx = current_head;
+  try
+  {
+    for(size_t i = 0; i < count; ++i)
+    {
+      Element* e = slot(idx);
+      *out = std::move(*e);
+      ++out;
+      std::destroy_at(e);
+      idx = increment(idx);
+    }
+  }
+  catch(...)
+  {
+    // release the elements already destroyed; the one that threw stays queued
+    _head.store(idx, std::memory_order_release);
+    throw;
+  }
+  if(count)
+    _head.store(idx, std::memory_order_release);
+  return count;
+}
+
 template<typename Element, size_t Size>
 bool CircularFifo<Element, Size>::wasEmpty() const
 {
@@ -110,5 +225,211 @@ size_t CircularFifo<Element, Size>::increment(size_t idx) const
   return (idx + 1) % Capacity;
 }
 
+
+// Padded variant: the producer-owned and consumer-owned indices live on separate
+// cache lines, together with a local copy of the opposite index. push only reloads
+// _head (acquire) when the cached copy says the queue is full, pop only reloads
+// _tail when the cached copy says it is empty. Indices are free-running counters
+// masked with a power-of-two slot count instead of "% Capacity", and exactly Size
+// elements can be stored. Storage and the push/emplace/pop/push_n/pop_n API are the
+// same as CircularFifo.
+template<typename Element, size_t Size>
+class CircularFifoPadded{
+public:
+  static_assert(Size > 0, "Size > 0");
+
+  static constexpr size_t kCacheLine = 64;
+  static constexpr size_t Slots = std::bit_ceil(Size);
+  static constexpr size_t Mask = Slots - 1;
+  enum { Capacity = Size };
+
+  CircularFifoPadded() : _tail(0), _headCache(0), _head(0), _tailCache(0) {}
+  virtual ~CircularFifoPadded() { destroyAll(); }
+
+  CircularFifoPadded(const CircularFifoPadded&) = delete;
+  CircularFifoPadded& operator=(const CircularFifoPadded&) = delete;
+
+  bool push(const Element& item) { return emplace(item); }
+  bool push(Element&& item) { return emplace(std::move(item)); }
+  template<typename... Args>
+  bool emplace(Args&&... args);
+
+  bool pop(Element& item);
+  std::optional<Element> pop();
+
+  template<typename InputIt>
+  size_t push_n(InputIt first, size_t n);
+  template<typename OutputIt>
+  size_t pop_n(OutputIt out, size_t n);
+
+  bool wasEmpty() const;
+  bool wasFull() const;
+  bool isLockFree() const;
+
+  // WARNING: not thread-safe, call only when no producer and consumer is running.
+  void clear() {
+    destroyAll();
+    _head.store(0, std::memory_order_release);
+    _tail.store(0, std::memory_order_release);
+    _headCache = 0;
+    _tailCache = 0;
+  }
+
+private:
+  Element* slot(size_t counter) { return std::launder(reinterpret_cast<Element*>(_array[counter & Mask])); }
+
+  void destroyAll() {
+    for(size_t i = _head.load(std::memory_order_relaxed); i != _tail.load(std::memory_order_relaxed); ++i)
+      std::destroy_at(slot(i));
+  }
+
+  // free slots as seen by the producer, refreshing _headCache only if fewer than wanted
+  size_t freeSlots(size_t current_tail, size_t wanted) {
+    size_t free = Size - (current_tail - _headCache);
+    if(free < wanted)
+    {
+      _headCache = _head.load(std::memory_order_acquire);
+      free = Size - (current_tail - _headCache);
+    }
+    return free;
+  }
+
+  // filled slots as seen by the consumer, refreshing _tailCache only if fewer than wanted
+  size_t filledSlots(size_t current_head, size_t wanted) {
+    size_t filled = _tailCache - current_head;
+    if(filled < wanted)
+    {
+      _tailCache = _tail.load(std::memory_order_acquire);
+      filled = _tailCache - current_head;
+    }
+    return filled;
+  }
+
+  // producer cache line
+  alignas(kCacheLine) std::atomic<size_t> _tail;  // tail(input) counter
+  size_t _headCache;                              // producer's copy of _head
+
+  // consumer cache line
+  alignas(kCacheLine) std::atomic<size_t> _head;  // head(output) counter
+  size_t _tailCache;                              // consumer's copy of _tail
+
+  alignas(kCacheLine) alignas(Element) unsigned char _array[Slots][sizeof(Element)];
+};
+
+template<typename Element, size_t Size>
+template<typename... Args>
+bool CircularFifoPadded<Element, Size>::emplace(Args&&... args)
+{
+  const auto current_tail = _tail.load(std::memory_order_relaxed);
+  if(freeSlots(current_tail, 1) == 0)
+    return false; // full queue
+
+  ::new (static_cast<void*>(_array[current_tail & Mask])) Element(std::forward<Args>(args)...);
+  _tail.store(current_tail + 1, std::memory_order_release);
+  return true;
+}
+
+template<typename Element, size_t Size>
+bool CircularFifoPadded<Element, Size>::pop(Element& item)
+{
+  const auto current_head = _head.load(std::memory_order_relaxed);
+  if(filledSlots(current_head, 1) == 0)
+    return false; // empty queue
+
+  Element* e = slot(current_head);
+  item = std::move(*e);
+  std::destroy_at(e);
+  _head.store(current_head + 1, std::memory_order_release);
+  return true;
+}
+
+template<typename Element, size_t Size>
+std::optional<Element> CircularFifoPadded<Element, Size>::pop()
+{
+  const auto current_head = _head.load(std::memory_order_relaxed);
+  if(filledSlots(current_head, 1) == 0)
+    return std::nullopt; // empty queue
+
+  Element* e = slot(current_head);
+  std::optional<Element> item(std::move(*e));
+  std::destroy_at(e);
+  _head.store(current_head + 1, std::memory_order_release);
+  return item;
+}
+
+template<typename Element, size_t Size>
+template<typename InputIt>
+size_t CircularFifoPadded<Element, Size>::push_n(InputIt first, size_t n)
+{
+  const auto current_tail = _tail.load(std::memory_order_relaxed);
+  const size_t free = freeSlots(current_tail, n);
+  const size_t count = n < free ? n : free;
+
+  size_t i = 0;
+  try
+  {
+    for(; i < count; ++i, ++first)
+      ::new (static_cast<void*>(_array[(current_tail + i) & Mask])) Element(*first);
+  }
+  catch(...)
+  {
+    // publish the elements constructed so far, the next push starts after them
+    _tail.store(current_tail + i, std::memory_order_release);
+    throw;
+  }
+  if(count)
+    _tail.store(current_tail + count, std::memory_order_release);
+  return count;
+}
+
+template<typename Element, size_t Size>
+template<typename OutputIt>
+size_t CircularFifoPadded<Element, Size>::pop_n(OutputIt out, size_t n)
+{
+  const auto current_head = _head.load(std::memory_order_relaxed);
+  const size_t filled = filledSlots(current_head, n);
+  const size_t count = n < filled ? n : filled;
+
+  size_t i = 0;
+  try
+  {
+    for(; i < count; ++i)
+    {
+      Element* e = slot(current_head + i);
+      *out = std::move(*e);
+      ++out;
+      std::destroy_at(e);
+    }
+  }
+  catch(...)
+  {
+    // release the elements already destroyed; the one that threw stays queued
+    _head.store(current_head + i, std::memory_order_release);
+    throw;
+  }
+  if(count)
+    _head.store(current_head + count, std::memory_order_release);
+  return count;
+}
+
+template<typename Element, size_t Size>
+bool CircularFifoPadded<Element, Size>::wasEmpty() const
+{
+  // snapshot with acceptance of that this comparison operation is not atomic
+  return (_head.load() == _tail.load());
+}
+
+template<typename Element, size_t Size>
+bool CircularFifoPadded<Element, Size>::wasFull() const
+{
+  return (_tail.load() - _head.load() == Size);
+}
+
+template<typename Element, size_t Size>
+bool CircularFifoPadded<Element, Size>::isLockFree() const
+{
+  return (_tail.is_lock_free() && _head.is_lock_free());
+}
+
 } // memory_relaxed_aquire_release
 #endif /* CIRCULARFIFO_AQUIRE_RELEASE_H_ */
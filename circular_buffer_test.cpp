@@ -1,10 +1,14 @@
 ﻿#include "gtest/gtest.h"
 #include "circular-buf.hpp" // 引入要测试的头文件
+#include "circular-buf-dynamic.hpp"
 #include <thread>
 #include <vector>
 #include <numeric>
 #include <atomic>
 #include <chrono>
+#include <memory>
+#include <iterator>
+#include <stdexcept>
 
 // --- 测试夹具 (Test Fixture) ---
 // 定义测试环境，为每个测试用例提供一个干净的 CircularBuffer 实例
@@ -198,4 +202,361 @@ TEST(CircularBufferConcurrencyTest, SPSC_CorrectnessAndIntegrity) {
     consumer.join();
 
     delete cb;
-}
\ No newline at end of file
+}
+// --- CircularFifoPadded 测试 ---
+
+// 容量恰好为 Size，满/空判断正确，回绕后仍保持顺序
+TEST(CircularFifoPaddedTest, CapacityAndWrapAround) {
+    memory_relaxed_aquire_release::CircularFifoPadded<int, 5> fifo;
+    static_assert(decltype(fifo)::Slots == 8);
+    EXPECT_TRUE(fifo.wasEmpty());
+
+    int value = 0;
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_TRUE(fifo.push(round * 10 + i));
+        }
+        EXPECT_TRUE(fifo.wasFull());
+        EXPECT_FALSE(fifo.push(-1));
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_TRUE(fifo.pop(value));
+            EXPECT_EQ(value, round * 10 + i);
+        }
+        EXPECT_FALSE(fifo.pop(value));
+    }
+    EXPECT_TRUE(fifo.isLockFree());
+}
+
+// 单生产者单消费者并发：顺序和数据完整
+TEST(CircularFifoPaddedTest, SPSC_Order) {
+    auto fifo = std::make_unique<memory_relaxed_aquire_release::CircularFifoPadded<uint32_t, 64>>();
+    const uint32_t total = 500000;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < total; ++i) {
+            while (!fifo->push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (uint32_t i = 0; i < total; ++i) {
+        uint32_t value;
+        while (!fifo->pop(value)) {
+            std::this_thread::yield();
+        }
+        ASSERT_EQ(value, i);
+    }
+    producer.join();
+}
+
+// --- CircularFifo 原地存储与批量接口测试 ---
+
+namespace {
+    // 没有默认构造函数、只能移动的元素
+    struct Frame {
+        Frame(int id, size_t bytes) : id(id), data(std::make_unique<uint8_t[]>(bytes)) {}
+        int id;
+        std::unique_ptr<uint8_t[]> data;
+    };
+}
+
+// 以下两个检查对 CircularFifo 和 CircularFifoPadded 都执行
+// （gtest_add_tests 无法发现 TYPED_TEST，因此使用模板函数）
+
+// emplace / 移动 push / optional pop 支持不可默认构造、不可复制的元素
+template <typename Fifo>
+static void checkEmplaceAndMoveOnlyElements() {
+    Fifo fifo;
+    ASSERT_TRUE(fifo.emplace(1, 16));
+    Frame frame(2, 16);
+    uint8_t* raw = frame.data.get();
+    ASSERT_TRUE(fifo.push(std::move(frame)));
+
+    auto first = fifo.pop();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->id, 1);
+
+    auto second = fifo.pop();
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->id, 2);
+    EXPECT_EQ(second->data.get(), raw); // 移动而非复制
+
+    EXPECT_FALSE(fifo.pop().has_value());
+
+    // 析构时仍在队列中的元素会被销毁（由 ASan/LSan 检查泄漏）
+    ASSERT_TRUE(fifo.emplace(3, 16));
+}
+
+// push_n / pop_n 批量操作，跨越回绕点并在满/空时返回部分数量
+template <typename Fifo>
+static void checkBatchPushAndPop() {
+    Fifo fifo;
+    std::vector<Frame> in;
+    for (int i = 0; i < 6; ++i) {
+        in.emplace_back(i, 8);
+    }
+
+    // 容量为 4，只能推入 4 个
+    EXPECT_EQ(fifo.push_n(std::make_move_iterator(in.begin()), in.size()), 4u);
+    std::vector<Frame> out;
+    EXPECT_EQ(fifo.pop_n(std::back_inserter(out), 3), 3u);
+
+    // 回绕后继续推入剩余元素
+    EXPECT_EQ(fifo.push_n(std::make_move_iterator(in.begin() + 4), 2), 2u);
+    EXPECT_EQ(fifo.pop_n(std::back_inserter(out), 10), 3u);
+    EXPECT_EQ(fifo.pop_n(std::back_inserter(out), 10), 0u);
+
+    ASSERT_EQ(out.size(), 6u);
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_EQ(out[i].id, i);
+        EXPECT_NE(out[i].data, nullptr);
+    }
+}
+
+TEST(CircularFifoTest, EmplaceAndMoveOnlyElements) {
+    checkEmplaceAndMoveOnlyElements<memory_relaxed_aquire_release::CircularFifo<Frame, 4>>();
+    checkEmplaceAndMoveOnlyElements<memory_relaxed_aquire_release::CircularFifoPadded<Frame, 4>>();
+}
+
+TEST(CircularFifoTest, BatchPushAndPop) {
+    checkBatchPushAndPop<memory_relaxed_aquire_release::CircularFifo<Frame, 4>>();
+    checkBatchPushAndPop<memory_relaxed_aquire_release::CircularFifoPadded<Frame, 4>>();
+}
+
+namespace {
+    // 统计存活实例数，并在第 throwAfter 次复制（构造或赋值）时抛出异常
+    struct Tracked {
+        static inline int live = 0;
+        static inline int throwAfter = -1;
+
+        explicit Tracked(int id) : id(id) { ++live; }
+        Tracked(const Tracked& other) : id(other.id) { countCopy(); ++live; }
+        Tracked& operator=(const Tracked& other) { countCopy(); id = other.id; return *this; }
+        ~Tracked() { --live; }
+
+        static void countCopy() {
+            if (throwAfter >= 0 && throwAfter-- == 0) {
+                throw std::runtime_error("copy failed");
+            }
+        }
+
+        int id;
+    };
+}
+
+// push_n / pop_n 中途抛出异常时，已完成的部分被发布，元素既不泄漏也不会被重复析构
+template <typename Fifo>
+static void checkBatchExceptionSafety() {
+    {
+        Fifo fifo;
+        std::vector<Tracked> in{ Tracked(0), Tracked(1), Tracked(2) };
+        const int baseline = Tracked::live;
+
+        // 第 3 个元素复制失败：前两个已入队
+        Tracked::throwAfter = 2;
+        EXPECT_THROW(fifo.push_n(in.begin(), in.size()), std::runtime_error);
+        EXPECT_EQ(Tracked::live, baseline + 2);
+        Tracked::throwAfter = -1;
+        EXPECT_EQ(fifo.push_n(in.begin() + 2, 1), 1u);
+
+        // 第 2 个元素赋值失败：第 1 个已出队，失败的元素仍留在队首
+        std::vector<Tracked> out{ Tracked(-1), Tracked(-1), Tracked(-1) };
+        Tracked::throwAfter = 1;
+        EXPECT_THROW(fifo.pop_n(out.begin(), out.size()), std::runtime_error);
+        Tracked::throwAfter = -1;
+        EXPECT_EQ(out[0].id, 0);
+        EXPECT_EQ(fifo.pop_n(out.begin() + 1, 2), 2u);
+        EXPECT_EQ(out[1].id, 1);
+        EXPECT_EQ(out[2].id, 2);
+        EXPECT_TRUE(fifo.wasEmpty());
+
+        // 析构时队列中剩余的元素被销毁一次
+        EXPECT_EQ(fifo.push_n(in.begin(), 2), 2u);
+    }
+    EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(CircularFifoTest, BatchExceptionSafety) {
+    checkBatchExceptionSafety<memory_relaxed_aquire_release::CircularFifo<Tracked, 4>>();
+    checkBatchExceptionSafety<memory_relaxed_aquire_release::CircularFifoPadded<Tracked, 4>>();
+}
+
+// --- CircularBuffer 零拷贝接口测试 ---
+
+// AcquireWriteChunk/CommitWriteChunk 直接写入环形缓冲区，AcquireReadChunk/ReleaseReadChunk 直接读取
+TEST_F(CircularBufferTest, ZeroCopyWriteAndRead) {
+    const size_t chunk = chunk_size;
+    size_t space = 0;
+    uint8_t* w = cb->AcquireWriteChunk(&space);
+    ASSERT_NE(w, nullptr);
+    ASSERT_EQ(space, chunk);
+    memcpy(w, "packet-1", 8);
+    cb->CommitWriteChunk(8); // 不满一块也立即可读
+
+    w = cb->AcquireWriteChunk(&space);
+    ASSERT_NE(w, nullptr);
+    memcpy(w, "packet-two", 10);
+    cb->CommitWriteChunk(10);
+
+    size_t size = 0;
+    uint8_t* r = cb->AcquireReadChunk(&size);
+    ASSERT_NE(r, nullptr);
+    ASSERT_EQ(size, 8u);
+    EXPECT_EQ(memcmp(r, "packet-1", 8), 0);
+    // 指针直接指向环形缓冲区内部，没有复制
+    EXPECT_EQ(r, w - chunk);
+    cb->ReleaseReadChunk();
+
+    // 字节流 Pop 也遵守每块的有效长度
+    uint8_t out[32] = { 0 };
+    EXPECT_EQ(cb->Pop(out, sizeof(out)), 10u);
+    EXPECT_EQ(memcmp(out, "packet-two", 10), 0);
+
+    EXPECT_EQ(cb->AcquireReadChunk(&size), nullptr);
+    EXPECT_EQ(size, 0u);
+}
+
+// 所有空闲块都被占用时 AcquireWriteChunk 返回 nullptr，释放读块后恢复
+TEST_F(CircularBufferTest, ZeroCopyBackpressure) {
+    size_t acquired = 0;
+    size_t space = 0;
+    while (uint8_t* w = cb->AcquireWriteChunk(&space)) {
+        w[0] = static_cast<uint8_t>(acquired);
+        cb->CommitWriteChunk(1);
+        ++acquired;
+    }
+    EXPECT_EQ(space, 0u);
+    EXPECT_EQ(acquired, size_t(chunks_count)); // 包括初始的写入块
+
+    size_t size = 0;
+    uint8_t* r = cb->AcquireReadChunk(&size);
+    ASSERT_NE(r, nullptr);
+    EXPECT_EQ(r[0], 0);
+    cb->ReleaseReadChunk();
+
+    EXPECT_NE(cb->AcquireWriteChunk(&space), nullptr);
+    EXPECT_EQ(space, size_t(chunk_size));
+}
+
+// --- DynamicCircularBuffer 测试 ---
+
+// 运行时指定大小；写满的块才对消费者可见，与 CircularBuffer 一致
+TEST(DynamicCircularBufferTest, PushPopAndWrapAround) {
+    DynamicCircularBuffer cb(4, 64);
+    EXPECT_EQ(cb.ChunksCount(), 4u);
+    EXPECT_EQ(cb.ChunkSize(), 64u);
+
+    std::vector<uint8_t> in(64 * 4);
+    std::iota(in.begin(), in.end(), 0);
+    EXPECT_EQ(cb.Push(in.data(), in.size()), in.size());
+    EXPECT_EQ(cb.Push(in.data(), 1), 0u); // 已满
+
+    std::vector<uint8_t> out(in.size());
+    EXPECT_EQ(cb.Pop(out.data(), 100), 100u);
+    // 消费者跨过两个块后，写端可以绕回开头继续写
+    EXPECT_EQ(cb.Push(in.data(), 64), 64u);
+    EXPECT_EQ(cb.Pop(out.data() + 100, out.size() - 100), out.size() - 100);
+    EXPECT_EQ(out, in);
+
+    std::vector<uint8_t> tail(64);
+    EXPECT_EQ(cb.Pop(tail.data(), tail.size()), 64u);
+    EXPECT_TRUE(std::equal(tail.begin(), tail.end(), in.begin()));
+}
+
+// 块数不是 2 的幂时，32 位计数器回绕前后仍按环形顺序使用各块，不会把两个在用的块映射到同一位置
+TEST(DynamicCircularBufferTest, CounterWrapWithNonPowerOfTwoChunks) {
+    DynamicCircularBuffer cb(3, 8);
+    cb.Flush(UINT32_MAX - 4);
+
+    uint8_t next_in = 0;
+    uint8_t next_out = 0;
+    uint8_t chunk[8];
+    // 保持环满，每轮先补满再取出一块，让计数器跨过 UINT32_MAX
+    for (int round = 0; round < 12; ++round) {
+        for (;;) {
+            for (auto &b : chunk) b = next_in + static_cast<uint8_t>(&b - chunk);
+            if (cb.Push(chunk, sizeof(chunk)) != sizeof(chunk)) break;
+            next_in += sizeof(chunk);
+        }
+        ASSERT_EQ(cb.Pop(chunk, sizeof(chunk)), sizeof(chunk));
+        for (size_t i = 0; i < sizeof(chunk); ++i) {
+            ASSERT_EQ(chunk[i], static_cast<uint8_t>(next_out + i)) << "round " << round;
+        }
+        next_out += sizeof(chunk);
+    }
+    while (cb.Pop(chunk, sizeof(chunk)) == sizeof(chunk)) {
+        for (size_t i = 0; i < sizeof(chunk); ++i) {
+            ASSERT_EQ(chunk[i], static_cast<uint8_t>(next_out + i));
+        }
+        next_out += sizeof(chunk);
+    }
+    EXPECT_EQ(next_out, next_in);
+}
+
+// 申请大页/锁定内存失败时自动回退，缓冲区仍然可用
+TEST(DynamicCircularBufferTest, HugePageOptionsFallBack) {
+    DynamicCircularBuffer::Options options;
+    options.huge_pages = true;
+    options.lock_memory = true;
+    DynamicCircularBuffer cb(8, 4096, options);
+
+    size_t space = 0;
+    uint8_t* w = cb.AcquireWriteChunk(&space);
+    ASSERT_NE(w, nullptr);
+    EXPECT_EQ(space, 4096u);
+    memcpy(w, "frame", 5);
+    cb.CommitWriteChunk(5);
+
+    size_t size = 0;
+    uint8_t* r = cb.AcquireReadChunk(&size);
+    ASSERT_NE(r, nullptr);
+    EXPECT_EQ(size, 5u);
+    EXPECT_EQ(memcmp(r, "frame", 5), 0);
+    cb.ReleaseReadChunk();
+}
+
+// 超时返回：空缓冲区 PopBlocking 返回 0，满缓冲区 PushBlocking 只写入能写的部分
+TEST(DynamicCircularBufferTest, BlockingTimeouts) {
+    DynamicCircularBuffer cb(2, 16);
+    uint8_t buf[64] = { 0 };
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(cb.PopBlocking(buf, sizeof(buf), std::chrono::milliseconds(20)), 0u);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    EXPECT_EQ(cb.PushBlocking(buf, sizeof(buf), std::chrono::milliseconds(20)), 32u);
+}
+
+// 生产者和消费者都使用阻塞接口，数据完整且有序
+TEST(DynamicCircularBufferTest, BlockingSPSC) {
+    DynamicCircularBuffer cb(4, 256);
+    const size_t total = 1 << 20;
+
+    std::thread producer([&]() {
+        std::vector<uint8_t> block(1000);
+        size_t sent = 0;
+        while (sent < total) {
+            size_t n = std::min(block.size(), total - sent);
+            for (size_t i = 0; i < n; ++i) {
+                block[i] = static_cast<uint8_t>((sent + i) * 7);
+            }
+            ASSERT_EQ(cb.PushBlocking(block.data(), n, std::chrono::seconds(10)), n);
+            sent += n;
+        }
+    });
+
+    std::vector<uint8_t> block(777);
+    size_t received = 0;
+    bool ok = true;
+    while (received < total) {
+        size_t n = cb.PopBlocking(block.data(), block.size(), std::chrono::seconds(10));
+        ASSERT_GT(n, 0u);
+        for (size_t i = 0; i < n && ok; ++i) {
+            ok = block[i] == static_cast<uint8_t>((received + i) * 7);
+        }
+        received += n;
+    }
+    producer.join();
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(received, total);
+}
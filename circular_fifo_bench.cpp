@@ -0,0 +1,99 @@
+// SPSC throughput comparison:
+//   memory_relaxed_aquire_release::CircularFifo        (original)
+//   memory_relaxed_aquire_release::CircularFifoPadded  (padded indices + cached opposite index)
+//   folly::ProducerConsumerQueue                        (when folly headers are available, see fo_queue.cpp)
+//
+// Usage: circular_fifo_bench [items] [repeats]
+
+#include "circular-fifo.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#if __has_include(<folly/ProducerConsumerQueue.h>)
+#include <folly/ProducerConsumerQueue.h>
+#define HAVE_FOLLY_PCQ 1
+#endif
+
+static constexpr size_t kQueueSize = 1024;
+
+// 生产者写入 0..items-1，消费者校验顺序并累加，返回耗时（纳秒）
+template <typename PushFn, typename PopFn>
+static double runSpsc(size_t items, PushFn&& push, PopFn&& pop)
+{
+  unsigned long long sum = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  std::thread consumer([&]() {
+    for (size_t i = 0; i < items; ++i) {
+      size_t value;
+      while (!pop(value)) {
+        std::this_thread::yield();
+      }
+      if (value != i) {
+        std::printf("order violation: got %zu, expected %zu\n", value, i);
+        std::exit(1);
+      }
+      sum += value;
+    }
+  });
+
+  for (size_t i = 0; i < items; ++i) {
+    while (!push(i)) {
+      std::this_thread::yield();
+    }
+  }
+  consumer.join();
+
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  if (sum != static_cast<unsigned long long>(items) * (items - 1) / 2) {
+    std::printf("checksum mismatch\n");
+    std::exit(1);
+  }
+  return elapsed;
+}
+
+template <typename Bench>
+static void report(const char* name, size_t items, int repeats, Bench&& bench)
+{
+  double best = 0;
+  for (int r = 0; r < repeats; ++r) {
+    double ns = bench();
+    if (r == 0 || ns < best) {
+      best = ns;
+    }
+  }
+  std::printf("%-28s %8.2f ns/item %10.2f Mitems/s\n", name, best / items, items / best * 1e3);
+}
+
+int main(int argc, char** argv)
+{
+  size_t items = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20'000'000;
+  int repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+  std::printf("SPSC, queue size %zu, %zu items, best of %d\n", kQueueSize, items, repeats);
+
+  report("CircularFifo", items, repeats, [&]() {
+    auto q = std::make_unique<memory_relaxed_aquire_release::CircularFifo<size_t, kQueueSize>>();
+    return runSpsc(items, [&](size_t v) { return q->push(v); }, [&](size_t& v) { return q->pop(v); });
+  });
+
+  report("CircularFifoPadded", items, repeats, [&]() {
+    auto q = std::make_unique<memory_relaxed_aquire_release::CircularFifoPadded<size_t, kQueueSize>>();
+    return runSpsc(items, [&](size_t v) { return q->push(v); }, [&](size_t& v) { return q->pop(v); });
+  });
+
+#if defined(HAVE_FOLLY_PCQ)
+  report("folly::ProducerConsumerQueue", items, repeats, [&]() {
+    // folly 的 size 包含一个保留槽位，可用容量为 size - 1
+    folly::ProducerConsumerQueue<size_t> q(kQueueSize + 1);
+    return runSpsc(items, [&](size_t v) { return q.write(v); }, [&](size_t& v) { return q.read(v); });
+  });
+#else
+  std::printf("%-28s (folly headers not found, skipped)\n", "folly::ProducerConsumerQueue");
+#endif
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // syscall()
+#elif !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L // clock_gettime(), nanosleep() under -std=c11
+#endif
+
+#include "futex_event.h"
+
+#include <limits.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#if defined(_MSC_VER)
+#pragma comment(lib, "Synchronization.lib") // WaitOnAddress / WakeByAddressAll
+#endif
+#else
+#include <errno.h>
+#include <time.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#endif
+
+#define NSEC_PER_MSEC INT64_C(1000000)
+#define NSEC_PER_SEC INT64_C(1000000000)
+
+// The deadline is kept in nanoseconds: truncating to whole milliseconds
+// could end a wait up to 1ms early
+static int64_t
+futex_event_now_ns(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (int64_t) (counter.QuadPart / freq.QuadPart) * NSEC_PER_SEC
+         + (int64_t) (counter.QuadPart % freq.QuadPart) * NSEC_PER_SEC
+                                                        / freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+#endif
+}
+
+// Sleep while ev->seq == seq, at most timeout_ns (negative: forever)
+static void
+futex_event_sleep(struct futex_event *ev, unsigned seq, int64_t timeout_ns) {
+#if defined(__linux__)
+    struct timespec ts;
+    struct timespec *pts = NULL;
+    if (timeout_ns >= 0) {
+        ts.tv_sec = (time_t) (timeout_ns / NSEC_PER_SEC);
+        ts.tv_nsec = (long) (timeout_ns % NSEC_PER_SEC);
+        pts = &ts;
+    }
+    syscall(SYS_futex, (unsigned *) &ev->seq, FUTEX_WAIT_PRIVATE, seq, pts,
+            NULL, 0);
+#elif defined(_WIN32)
+    // Round up, the caller loops until the deadline anyway
+    int64_t timeout_ms = timeout_ns < 0 ? -1
+                       : (timeout_ns + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC;
+    DWORD ms = timeout_ms < 0 ? INFINITE
+             : timeout_ms >= (int64_t) INFINITE ? INFINITE - 1
+             : (DWORD) timeout_ms;
+    WaitOnAddress((volatile VOID *) &ev->seq, &seq, sizeof(seq), ms);
+#else
+    // No address wait available: poll with a short sleep
+    (void) ev;
+    (void) seq;
+    struct timespec ts = {0, (long) NSEC_PER_MSEC};
+    if (timeout_ns >= 0 && timeout_ns < NSEC_PER_MSEC) {
+        ts.tv_nsec = (long) timeout_ns;
+    }
+    nanosleep(&ts, NULL);
+#endif
+}
+
+void
+futex_event_init(struct futex_event *ev) {
+    atomic_init(&ev->seq, 0);
+    atomic_init(&ev->waiters, 0);
+}
+
+void
+futex_event_wake(struct futex_event *ev) {
+    atomic_fetch_add_explicit(&ev->seq, 1, memory_order_release);
+#if defined(__linux__)
+    syscall(SYS_futex, (unsigned *) &ev->seq, FUTEX_WAKE_PRIVATE, INT_MAX,
+            NULL, NULL, 0);
+#elif defined(_WIN32)
+    WakeByAddressAll((PVOID) &ev->seq);
+#endif
+}
+
+bool
+futex_event_wait_until(struct futex_event *ev, bool (*ready)(void *ctx),
+                       void *ctx, int timeout_ms) {
+    if (ready(ctx)) {
+        return true;
+    }
+    int64_t deadline = timeout_ms < 0
+                     ? -1
+                     : futex_event_now_ns() + timeout_ms * NSEC_PER_MSEC;
+
+    atomic_fetch_add_explicit(&ev->waiters, 1, memory_order_relaxed);
+    bool ok;
+    for (;;) {
+        unsigned seq = atomic_load_explicit(&ev->seq, memory_order_acquire);
+        // Pairs with the fence in futex_event_signal()
+        atomic_thread_fence(memory_order_seq_cst);
+        ok = ready(ctx);
+        if (ok) {
+            break;
+        }
+        int64_t remaining = -1;
+        if (deadline >= 0) {
+            remaining = deadline - futex_event_now_ns();
+            if (remaining <= 0) {
+                break;
+            }
+        }
+        futex_event_sleep(ev, seq, remaining);
+    }
+    atomic_fetch_sub_explicit(&ev->waiters, 1, memory_order_relaxed);
+    return ok;
+}
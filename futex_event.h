@@ -0,0 +1,58 @@
+#ifndef FUTEX_EVENT_H
+#define FUTEX_EVENT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Wake-on-demand event for lock-free single-producer queues.
+ *
+ * A consumer that wants to sleep announces itself in `waiters` and waits
+ * on `seq` (futex on Linux, WaitOnAddress on Windows). The producer calls
+ * futex_event_signal() after publishing data; it only makes a syscall
+ * when a waiter is registered, so the non-waiting path costs one fence
+ * and one load.
+ */
+struct futex_event {
+    atomic_uint seq;     // bumped by every wake
+    atomic_uint waiters; // consumers currently between prepare and finish
+};
+
+void
+futex_event_init(struct futex_event *ev);
+
+void
+futex_event_wake(struct futex_event *ev);
+
+/**
+ * Producer side, call after the data has been published (release store).
+ */
+static inline void
+futex_event_signal(struct futex_event *ev) {
+    // Pairs with the fence in futex_event_wait_until(): either the waiter
+    // sees the new data, or we see the waiter
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ev->waiters, memory_order_relaxed)) {
+        futex_event_wake(ev);
+    }
+}
+
+/**
+ * Consumer side: sleep until ready(ctx) returns true or timeout_ms
+ * elapses (negative means no timeout).
+ *
+ * @return the last result of ready(ctx)
+ */
+bool
+futex_event_wait_until(struct futex_event *ev, bool (*ready)(void *ctx),
+                       void *ctx, int timeout_ms);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif
@@ -1,8 +1,11 @@
 ﻿#include "looper_handler.h" // Include the header first
+#include "Numa.h"
 
 #include <iostream> // For std::cout, std::cerr (used in implementations and main)
 #include <algorithm> // for std::find_if, std::sort, std::remove_if, std::upper_bound (used in MessageQueue impl)
-#include <utility>   // For std::move
+#include <iterator>  // For std::back_inserter (dropped messages)
+#include <utility>   // For std::move, std::exchange
+#include <cstdint>   // For uint64_t (SyncSlot generation)
 
 namespace core {
     // --- Message Implementation ---
@@ -42,7 +45,23 @@ namespace core {
     }
 
     // --- MessageQueue Implementation ---
-    MessageQueue::MessageQueue() = default; // Definition
+    // 创建绑定到节点的上游内存资源；节点无效或系统不支持 NUMA 时返回 nullptr
+    static std::unique_ptr<NumaMemoryResource> makeNodeResource(int numaNode) {
+        if (numaNode < 0) return nullptr;
+        auto resource = std::make_unique<NumaMemoryResource>(numaNode);
+        if (resource->node() < 0) return nullptr;
+        return resource;
+    }
+
+    MessageQueue::MessageQueue(int numaNode)
+        : mUpstreamResource(makeNodeResource(numaNode)),
+        // 上游按页从节点分配，池负责复用 deque 的内存块，稳态下不会再有系统调用
+        mPoolResource(mUpstreamResource
+            ? std::make_unique<std::pmr::unsynchronized_pool_resource>(mUpstreamResource.get())
+            : nullptr),
+        mMessages(mPoolResource ? mPoolResource.get() : std::pmr::get_default_resource()),
+        mAsyncMessages(mPoolResource ? mPoolResource.get() : std::pmr::get_default_resource()) {
+    }
     MessageQueue::~MessageQueue() = default; // Definition
 
     // Enqueues a message. Messages are sorted by their 'when' time. 
@@ -59,11 +78,13 @@ namespace core {
         // 这样，`next()` 方法总是可以只看队列的头部，来确定下一条需要处理的消息以及需要等待多久。
         // 这是一种空间换时间的优化，避免了在 `next()` 中遍历整个队列来寻找最早的消息。
         
-        auto it = std::upper_bound(mMessages.begin(), mMessages.end(), msg,
+        // 异步消息单独排序保存，这样同步屏障只需要挡住 mMessages 的队首。
+        MessageList& messages = msg.async ? mAsyncMessages : mMessages;
+        auto it = std::upper_bound(messages.begin(), messages.end(), msg,
             [](const Message& a, const Message& b) {
                 return a.when < b.when;
             });
-        mMessages.insert(it, std::move(msg));
+        messages.insert(it, std::move(msg));
 
         // 理论上，只有当插入的消息成为新的队首时（即它是最早需要执行的任务），或者队列之前为空时，
         // 才“必须”唤醒线程。但是，为了逻辑简化和健壮性，这里选择总是通知。
@@ -85,10 +106,18 @@ namespace core {
             return false; // Don't enqueue if quitting
         }
 
-        // 设置时间为当前，以保持一致性
+        // 时间不晚于队首，保持队列按 'when' 有序；同步消息还不能晚于第一个屏障，
+        // 否则它会被屏障挡住，并连带挡住屏障之前本该执行的同步消息
+        MessageList& messages = msg.async ? mAsyncMessages : mMessages;
         msg.when = std::chrono::steady_clock::now();
+        if (!messages.empty()) {
+            msg.when = std::min(msg.when, messages.front().when);
+        }
+        if (!msg.async && !mBarriers.empty()) {
+            msg.when = std::min(msg.when, mBarriers.front().when);
+        }
         // 关键：使用 push_front 将消息插入到双端队列的头部
-        mMessages.push_front(std::move(msg));
+        messages.push_front(std::move(msg));
 
         // 必须唤醒 Looper，因为它可能正在为一个延迟任务而休眠。
         // 新的队首任务需要立即被评估。
@@ -96,25 +125,77 @@ namespace core {
         return true;
     }
 
+    size_t MessageQueue::enqueueMessages(std::span<Message> msgs, std::chrono::steady_clock::time_point when) {
+        if (msgs.empty()) return 0;
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mQuitting) {
+            std::cerr << "Warning: Enqueuing messages on a quitting queue." << std::endl;
+            return 0;
+        }
+
+        // 整批消息的 when 相同，每个队列只需做一次 upper_bound 找到插入位置，
+        // 之后依次插在其后即可保持批内顺序。通常插入位置就是队尾。
+        size_t syncPos = std::upper_bound(mMessages.begin(), mMessages.end(), when,
+            [](const std::chrono::steady_clock::time_point& t, const Message& m) { return t < m.when; })
+            - mMessages.begin();
+        size_t asyncPos = std::upper_bound(mAsyncMessages.begin(), mAsyncMessages.end(), when,
+            [](const std::chrono::steady_clock::time_point& t, const Message& m) { return t < m.when; })
+            - mAsyncMessages.begin();
+
+        for (Message& msg : msgs) {
+            msg.when = when;
+            if (msg.async) {
+                mAsyncMessages.insert(mAsyncMessages.begin() + asyncPos++, std::move(msg));
+            }
+            else {
+                mMessages.insert(mMessages.begin() + syncPos++, std::move(msg));
+            }
+        }
+
+        mCondVar.notify_one();
+        return msgs.size();
+    }
+
     // Retrieves the next message. Blocks if the queue is empty or
     // the next message is scheduled for the future.
     // Returns std::nullopt if the queue is quitting. 
     std::optional<Message> MessageQueue::next() {
+        std::vector<Message> dropped; // destroyed after the lock is released
         std::unique_lock<std::mutex> lock(mMutex); // Use the mutable mutex
         auto now = std::chrono::steady_clock::now();
         std::chrono::steady_clock::time_point nextPollTimeout = now; // Initialize just in case
 
         while (true) {
             if (mQuitting) {
-                return std::nullopt; // Return nullopt if quitting
+                if (mQuit) {
+                    return std::nullopt; // Return nullopt if quitting
+                }
+                if (now >= mQuitDeadline) {
+                    // quitWithin() 的排空时间已到，剩余消息全部丢弃
+                    dropAllLocked(dropped);
+                    return std::nullopt;
+                }
+            }
+
+            // 候选消息只有两个：同步队列的队首（未被屏障挡住时）和异步队列的队首。
+            // 两个队列各自有序，所以取两者中较早的一个即可，无需遍历。
+            MessageList* source = nullptr;
+            if (!mMessages.empty()
+                && (mBarriers.empty() || mMessages.front().when <= mBarriers.front().when)) {
+                source = &mMessages;
+            }
+            if (!mAsyncMessages.empty()
+                && (!source || mAsyncMessages.front().when < source->front().when)) {
+                source = &mAsyncMessages;
             }
 
-            if (!mMessages.empty()) {
-                const auto& frontMsg = mMessages.front();
+            if (source) {
+                const auto& frontMsg = source->front();
                 if (frontMsg.when <= now) {
                     // Message is ready to be processed
-                    Message msg = std::move(mMessages.front());
-                    mMessages.pop_front();
+                    Message msg = std::move(source->front());
+                    source->pop_front();
                     return std::move(msg);
                 }
                 else {
@@ -123,10 +204,16 @@ namespace core {
                 }
             }
             else {
-                // Queue is empty, wait indefinitely until notified
+                // Queue is empty (or blocked by a barrier), wait indefinitely until notified
                 nextPollTimeout = std::chrono::steady_clock::time_point::max();
             }
 
+            if (mQuitting) {
+                // 安全退出时不会再有新消息入队，没有到期的消息就说明已经排空
+                dropAllLocked(dropped);
+                return std::nullopt;
+            }
+
             // `mCondVar.wait_until` 或 `mCondVar.wait` 会原子地解锁互斥锁 `mMutex` 并让线程进入休眠。
             // 这样做是为了避免 CPU 空转，节省资源。
             // 线程会被以下两种情况之一唤醒：
@@ -148,42 +235,154 @@ namespace core {
 
     // Signals the queue to stop processing messages. 
     void MessageQueue::quit() {
+        std::vector<Message> dropped;
         std::unique_lock<std::mutex> lock(mMutex); // Use the mutable mutex
-        if (!mQuitting) {
+        if (!mQuit) {
             mQuitting = true;
-            mMessages.clear(); // Optionally clear pending messages on quit
+            dropAllLocked(dropped); // Clear pending messages on quit
             mCondVar.notify_all(); // Wake up the looper thread if it's waiting
         }
     }
 
+    size_t MessageQueue::quitSafely(std::chrono::steady_clock::time_point drainDeadline) {
+        std::vector<Message> droppedMessages;
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mQuit) {
+            return 0;
+        }
+        mQuitting = true;
+        mQuitDeadline = std::min(mQuitDeadline, drainDeadline);
+
+        // 两个队列都按 'when' 排序，延迟消息都在队尾，直接截断即可
+        auto now = std::chrono::steady_clock::now();
+        size_t dropped = 0;
+        for (MessageList* messages : { &mMessages, &mAsyncMessages }) {
+            auto it = std::upper_bound(messages->begin(), messages->end(), now,
+                [](const std::chrono::steady_clock::time_point& t, const Message& m) {
+                    return t < m.when;
+                });
+            dropped += static_cast<size_t>(std::distance(it, messages->end()));
+            std::move(it, messages->end(), std::back_inserter(droppedMessages));
+            messages->erase(it, messages->end());
+        }
+        // 屏障会让到期的同步消息永远无法被处理，所以安全退出时一并移除
+        mBarriers.clear();
+        mDroppedCount += dropped;
+
+        mCondVar.notify_all(); // Wake up the looper so it can drain or finish
+        return dropped;
+    }
+
+    size_t MessageQueue::awaitQuit(std::chrono::steady_clock::time_point deadline) {
+        std::vector<Message> dropped;
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (!mQuitCondVar.wait_until(lock, deadline, [this]() { return mQuit; })) {
+            // 超时：Looper 可能仍在执行某个耗时消息，直接丢弃剩余消息
+            dropAllLocked(dropped);
+            mCondVar.notify_all();
+        }
+        return mDroppedCount;
+    }
+
+    template <typename Pred>
+    void MessageQueue::extractLocked(MessageList& messages, Pred pred, std::vector<Message>& dropped) {
+        auto kept = messages.begin();
+        for (auto it = messages.begin(); it != messages.end(); ++it) {
+            if (pred(*it)) {
+                dropped.push_back(std::move(*it));
+            }
+            else {
+                if (kept != it) {
+                    *kept = std::move(*it);
+                }
+                ++kept;
+            }
+        }
+        messages.erase(kept, messages.end());
+    }
+
+    size_t MessageQueue::dropAllLocked(std::vector<Message>& droppedMessages) {
+        size_t dropped = mMessages.size() + mAsyncMessages.size();
+        droppedMessages.reserve(droppedMessages.size() + dropped);
+        std::move(mMessages.begin(), mMessages.end(), std::back_inserter(droppedMessages));
+        std::move(mAsyncMessages.begin(), mAsyncMessages.end(), std::back_inserter(droppedMessages));
+        mMessages.clear();
+        mAsyncMessages.clear();
+        mBarriers.clear();
+        mDroppedCount += dropped;
+        if (!mQuit) {
+            mQuit = true;
+            mQuitCondVar.notify_all();
+        }
+        return dropped;
+    }
+
     // 
     bool MessageQueue::isQuitting() const {
         std::lock_guard<std::mutex> lock(mMutex); // Use the mutable mutex
         return mQuitting;
     }
 
+    bool MessageQueue::hasQuit() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mQuit;
+    }
+
+    int MessageQueue::getNumaNode() const {
+        // 分配时 mbind 失败会让资源放弃节点绑定，因此每次都从资源读取
+        return mUpstreamResource ? mUpstreamResource->node() : -1;
+    }
+
     // Removes messages for a specific handler with a specific 'what' code 
     void MessageQueue::removeMessages(const std::shared_ptr<Handler>& h, int what) {
+        std::vector<Message> dropped;
         std::unique_lock<std::mutex> lock(mMutex); // Use the mutable mutex
         if (mQuitting) return;
 
-        mMessages.erase(std::remove_if(mMessages.begin(), mMessages.end(),
-            [&](const Message& msg) {
-                return msg.target == h && msg.what == what && !msg.callback; // Only remove non-callback messages
-            }),
-            mMessages.end());
+        auto matches = [&](const Message& msg) {
+            return msg.target == h && msg.what == what && !msg.callback; // Only remove non-callback messages
+        };
+        extractLocked(mMessages, matches, dropped);
+        extractLocked(mAsyncMessages, matches, dropped);
     }
 
     // Removes callback runnables for a specific handler 
     void MessageQueue::removeCallbacks(const std::shared_ptr<Handler>& h) {
+        std::vector<Message> dropped;
         std::unique_lock<std::mutex> lock(mMutex); // Use the mutable mutex
         if (mQuitting) return;
 
-        mMessages.erase(std::remove_if(mMessages.begin(), mMessages.end(),
-            [&](const Message& msg) {
-                return msg.target == h && msg.callback; // Only remove callback messages
-            }),
-            mMessages.end());
+        auto matches = [&](const Message& msg) {
+            return msg.target == h && msg.callback; // Only remove callback messages
+        };
+        extractLocked(mMessages, matches, dropped);
+        extractLocked(mAsyncMessages, matches, dropped);
+    }
+
+    int MessageQueue::postSyncBarrier() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        int token = mNextBarrierToken++;
+        // steady_clock 单调递增，所以 push_back 即可保持 mBarriers 按时间有序。
+        // 屏障只会让 next() 等待更久，因此这里不需要唤醒 Looper。
+        mBarriers.push_back({ token, std::chrono::steady_clock::now() });
+        return token;
+    }
+
+    bool MessageQueue::removeSyncBarrier(int token) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = std::find_if(mBarriers.begin(), mBarriers.end(),
+            [token](const SyncBarrier& b) { return b.token == token; });
+        if (it == mBarriers.end()) {
+            std::cerr << "Warning: removeSyncBarrier() called with an unknown token " << token << std::endl;
+            return false;
+        }
+        bool wasFront = it == mBarriers.begin();
+        mBarriers.erase(it);
+        // 移除最前面的屏障可能放行被挡住的同步消息，需要唤醒 Looper 重新评估
+        if (wasFront) {
+            mCondVar.notify_one();
+        }
+        return true;
     }
 
 
@@ -193,19 +392,19 @@ namespace core {
     thread_local std::shared_ptr<Looper> Looper::tLooper = nullptr;
 
     // Private constructor: Use static methods prepare()/myLooper() 
-    Looper::Looper()
-        : mQueue(std::make_unique<MessageQueue>()), mThreadId(std::this_thread::get_id()) // Initializer list sets members
+    Looper::Looper(int numaNode)
+        : mQueue(std::make_unique<MessageQueue>(numaNode)), mThreadId(std::this_thread::get_id()) // Initializer list sets members
     {
     }
 
     // Prepares a Looper for the calling thread. Must be called before loop(). 
-    void Looper::prepare() {
+    void Looper::prepare(int numaNode) {
         if (tLooper) {
             throw std::runtime_error("Looper already prepared for this thread.");
         }
         // Create Looper and store it in thread_local variable
-        struct LooperMaker : public Looper { LooperMaker() : Looper() {} }; // Helper to access private constructor
-        tLooper = std::make_shared<LooperMaker>();
+        struct LooperMaker : public Looper { explicit LooperMaker(int node) : Looper(node) {} }; // Helper to access private constructor
+        tLooper = std::make_shared<LooperMaker>(numaNode);
     }
 
     // Returns the Looper associated with the calling thread.
@@ -295,6 +494,23 @@ namespace core {
         }
     }
 
+    size_t Looper::quitSafely() {
+        if (!mQueue) return 0;
+        return mQueue->quitSafely();
+    }
+
+    size_t Looper::quitWithin(long timeoutMillis) {
+        if (!mQueue) return 0;
+        if (timeoutMillis < 0) timeoutMillis = 0;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMillis);
+        size_t dropped = mQueue->quitSafely(deadline);
+        if (mThreadId == std::this_thread::get_id()) {
+            // 在 Looper 自己的线程上等待只会死锁，截止时间由 next() 负责执行
+            return dropped;
+        }
+        return mQueue->awaitQuit(deadline);
+    }
+
     // Gets the message queue associated with this Looper.
     // Be cautious when using the queue directly. 
     MessageQueue* Looper::getQueue() const {
@@ -306,6 +522,10 @@ namespace core {
         return mThreadId;
     }
 
+    int Looper::getNumaNode() const {
+        return mQueue ? mQueue->getNumaNode() : -1;
+    }
+
 
     // --- Handler Implementation ---
 
@@ -320,7 +540,8 @@ namespace core {
     }
 
     // Creates a Handler associated with a specific Looper. 
-    Handler::Handler(std::shared_ptr<Looper> looper) : mLooper(std::move(looper)) {
+    Handler::Handler(std::shared_ptr<Looper> looper, bool async)
+        : mLooper(std::move(looper)), mAsynchronous(async) {
         if (!mLooper) {
             throw std::invalid_argument("Looper cannot be null");
         }
@@ -356,9 +577,20 @@ namespace core {
     bool Handler::sendMessageAtTime(Message&& msg, std::chrono::steady_clock::time_point uptimeMillis) {
         if (!mQueue) return false; // Should not happen if constructor succeeded
         msg.target = shared_from_this(); // Set the target handler
+        if (mAsynchronous) msg.async = true;
         return mQueue->enqueueMessage(std::move(msg), uptimeMillis);
     }
 
+    size_t Handler::sendMessages(std::span<Message> msgs) {
+        if (!mQueue) return 0;
+        auto self = shared_from_this();
+        for (Message& msg : msgs) {
+            msg.target = self;
+            if (mAsynchronous) msg.async = true;
+        }
+        return mQueue->enqueueMessages(msgs, std::chrono::steady_clock::now());
+    }
+
     // --- Runnable Posting Methods ---
 
     // Posts a task (std::function) to be run on the Handler's thread. 
@@ -378,12 +610,14 @@ namespace core {
     bool Handler::postAtTime(std::function<void()> r, std::chrono::steady_clock::time_point uptimeMillis) {
         if (!mQueue) return false;
         Message msg(std::move(r), shared_from_this()); // Create message with callback
+        msg.async = mAsynchronous;
         return mQueue->enqueueMessage(std::move(msg), uptimeMillis);
     }
  
     bool Handler::postAtFrontOfQueue(std::function<void()> r) {
         if (!mQueue) return false;
         Message msg(std::move(r), shared_from_this());
+        msg.async = mAsynchronous;
         return mQueue->enqueueMessageAtFront(std::move(msg));
     }
 
@@ -450,6 +684,203 @@ namespace core {
         return mLooper;
     }
 
+    // --- Synchronous Invocation Implementation ---
+
+    // runSync 的完成槽。每个调用线程在第一次调用 runSync 时从全局空闲链表取得一个槽，
+    // 之后的同步调用都复用它，因此不需要为每次调用分配 promise/future 共享状态。
+    // 槽从不释放：线程退出时会归还到空闲链表。这样即使超时后仍留在队列中的过期消息
+    // 稍后才被执行，它访问的内存也依然有效，并可以通过 generation 判断自己已经过期。
+    struct Handler::SyncSlot {
+        enum class State { Idle, Pending, Running, Done, Dropped };
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        uint64_t generation = 0;
+        State state = State::Idle;
+        void* ctx = nullptr;
+        void (*thunk)(void*) = nullptr;
+        std::exception_ptr error;
+        int runners = 0; // 当前 generation 仍存活的 Runner 副本数
+        SyncSlot* nextFree = nullptr;
+
+        class Runner;
+
+        // 在 Looper 线程上执行，generation 不匹配说明调用者已经超时放弃
+        void run(uint64_t gen) {
+            void* c = nullptr;
+            void (*t)(void*) = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (generation != gen || state != State::Pending) {
+                    return;
+                }
+                state = State::Running;
+                c = ctx;
+                t = thunk;
+            }
+
+            std::exception_ptr err;
+            try {
+                t(c);
+            }
+            catch (...) {
+                err = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = err;
+                state = State::Done;
+            }
+            cond.notify_one();
+        }
+
+        static std::mutex& poolMutex() {
+            static std::mutex m;
+            return m;
+        }
+
+        static SyncSlot*& freeList() {
+            static SyncSlot* head = nullptr;
+            return head;
+        }
+
+        static SyncSlot* acquire() {
+            {
+                std::lock_guard<std::mutex> lock(poolMutex());
+                SyncSlot*& head = freeList();
+                if (head) {
+                    SyncSlot* slot = head;
+                    head = slot->nextFree;
+                    slot->nextFree = nullptr;
+                    return slot;
+                }
+            }
+            return new SyncSlot();
+        }
+
+        static void release(SyncSlot* slot) {
+            std::lock_guard<std::mutex> lock(poolMutex());
+            slot->nextFree = freeList();
+            freeList() = slot;
+        }
+    };
+
+    /**
+     * 投递到队列的可调用对象，执行 SyncSlot::run(gen)。
+     *
+     * 与 FutureStateRunner 相同，它在槽上登记引用计数：如果最后一个副本在执行前被销毁
+     * （例如被 removeCallbacks() 移除），槽会进入 Dropped 状态并唤醒调用者。
+     * generation 不匹配的副本属于已经放弃的调用，不参与计数。
+     */
+    class Handler::SyncSlot::Runner {
+    public:
+        // 调用者已在槽锁内把 runners 置为 1，这里只接管该计数
+        Runner(SyncSlot* slot, uint64_t gen) : mSlot(slot), mGen(gen) {}
+
+        Runner(const Runner& other) : mSlot(other.mSlot), mGen(other.mGen) {
+            if (mSlot) {
+                std::lock_guard<std::mutex> lock(mSlot->mutex);
+                if (mSlot->generation == mGen) ++mSlot->runners;
+            }
+        }
+
+        Runner(Runner&& other) noexcept : mSlot(std::exchange(other.mSlot, nullptr)), mGen(other.mGen) {}
+
+        Runner& operator=(const Runner&) = delete;
+        Runner& operator=(Runner&&) = delete;
+
+        ~Runner() {
+            if (!mSlot) return;
+            bool dropped = false;
+            {
+                std::lock_guard<std::mutex> lock(mSlot->mutex);
+                if (mSlot->generation == mGen && --mSlot->runners == 0
+                    && mSlot->state == State::Pending) {
+                    mSlot->state = State::Dropped;
+                    dropped = true;
+                }
+            }
+            if (dropped) mSlot->cond.notify_one();
+        }
+
+        void operator()() {
+            mSlot->run(mGen);
+        }
+
+    private:
+        SyncSlot* mSlot;
+        uint64_t mGen;
+    };
+
+    // 等待期间检查队列是否已退出的间隔。退出时队列中的消息会被丢弃，
+    // 若不检查，runSync 会一直等待一个永远不会执行的任务。
+    static constexpr auto kSyncQuitPollInterval = std::chrono::milliseconds(20);
+
+    bool Handler::runSyncImpl(void* ctx, void (*thunk)(void*), long timeoutMillis) {
+        if (!mQueue) return false;
+
+        struct SlotHolder {
+            SyncSlot* slot = SyncSlot::acquire();
+            ~SlotHolder() { SyncSlot::release(slot); }
+        };
+        thread_local SlotHolder holder;
+        SyncSlot* slot = holder.slot;
+
+        uint64_t gen;
+        {
+            std::lock_guard<std::mutex> lock(slot->mutex);
+            gen = ++slot->generation;
+            slot->state = SyncSlot::State::Pending;
+            slot->ctx = ctx;
+            slot->thunk = thunk;
+            slot->error = nullptr;
+            slot->runners = 1;
+        }
+
+        // Runner 只有两个标量，可以放进 std::function 的小对象缓冲区
+        if (!post(SyncSlot::Runner(slot, gen))) {
+            std::lock_guard<std::mutex> lock(slot->mutex);
+            slot->state = SyncSlot::State::Idle;
+            return false;
+        }
+
+        auto deadline = timeoutMillis > 0
+            ? std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMillis)
+            : std::chrono::steady_clock::time_point::max();
+
+        std::unique_lock<std::mutex> lock(slot->mutex);
+        while (slot->state != SyncSlot::State::Done) {
+            if (slot->state == SyncSlot::State::Running) {
+                // fn 正在执行并引用调用者的栈，必须等它结束
+                slot->cond.wait(lock);
+                continue;
+            }
+            if (slot->state == SyncSlot::State::Dropped) {
+                // 任务在执行前被移出队列，不会再运行
+                slot->state = SyncSlot::State::Idle;
+                return false;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline || mQueue->hasQuit()) {
+                // 任务尚未开始，作废本次 generation 后即可安全返回
+                ++slot->generation;
+                slot->state = SyncSlot::State::Idle;
+                return false;
+            }
+            slot->cond.wait_until(lock, std::min(deadline, now + kSyncQuitPollInterval));
+        }
+
+        std::exception_ptr error = std::exchange(slot->error, nullptr);
+        slot->state = SyncSlot::State::Idle;
+        lock.unlock();
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return true;
+    }
+
 }
 
 #if 0
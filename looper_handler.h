@@ -3,6 +3,7 @@
 
 #include <queue> // Included for completeness, though deque is used
 #include <deque> 
+#include <memory_resource> // For std::pmr::deque (NUMA-local queue storage)
 #include <thread> // For std::thread::id
 #include <mutex> // For std::mutex
 #include <condition_variable> // For std::condition_variable
@@ -14,12 +15,17 @@
 #include <any> // C++17, or use void* with caution for older standards
 #include <stdexcept> // For std::runtime_error, std::invalid_argument (used in Handler constructor declaration)
 #include <cassert>   // for assertions (used in Handler constructor declaration)
+#include <span> // For std::span (batch enqueue)
+#include <future> // For std::future, std::packaged_task (used by Handler::invoke)
+#include <type_traits> // For std::invoke_result_t
+#include <vector> // For the messages dropped under the queue lock
 
 namespace core {
     // Forward declarations
     class Handler;
     class MessageQueue;
     class Looper;
+    class NumaMemoryResource;
 
     // Represents a message or task to be processed
     struct Message {
@@ -30,6 +36,7 @@ namespace core {
         std::shared_ptr<Handler> target;      // The handler that will process this message (Needs Handler fwd decl)
         std::function<void()> callback;       // Optional runnable task
         std::chrono::steady_clock::time_point when; // When the message should be processed
+        bool async = false;                   // Asynchronous messages are not held back by sync barriers
 
         // Default constructor
         Message() = default;
@@ -55,7 +62,8 @@ namespace core {
     // Thread-safe message queue
     class MessageQueue {
     public:
-        MessageQueue(); // Default constructor declaration
+        // numaNode >= 0 时，队列的存储从该 NUMA 节点分配（不支持 NUMA 时自动退化为普通分配）
+        explicit MessageQueue(int numaNode = -1);
         ~MessageQueue(); // Default destructor declaration
 
         // Non-copyable and non-movable
@@ -67,6 +75,13 @@ namespace core {
 
         bool enqueueMessageAtFront(Message&& msg);
 
+        /**
+         * @brief 批量入队：在一次加锁、一次唤醒内将 msgs 中的所有消息按顺序入队，when 相同。
+         * msgs 中的消息会被移走。
+         * @return 被接受的消息数量；队列正在退出时为 0。
+         */
+        size_t enqueueMessages(std::span<Message> msgs, std::chrono::steady_clock::time_point when);
+
         // Retrieves the next message. Blocks if the queue is empty or
         // the next message is scheduled for the future.
         // Returns std::nullopt if the queue is quitting.
@@ -75,17 +90,87 @@ namespace core {
         // Signals the queue to stop processing messages.
         void quit();
 
+        /**
+         * @brief 安全退出：丢弃所有 when 晚于当前时间的消息（并移除所有同步屏障），
+         * 已经到期的消息会继续被 next() 返回，全部处理完后 next() 才返回 std::nullopt。
+         * 调用之后不再接受新消息。
+         * @param drainDeadline 排空的截止时间，到期后仍未处理的消息会被丢弃。
+         * @return 本次调用立即丢弃的延迟消息数量。
+         */
+        size_t quitSafely(std::chrono::steady_clock::time_point drainDeadline =
+            std::chrono::steady_clock::time_point::max());
+
+        /**
+         * @brief 等待退出完成（队列已排空）或到达 deadline。
+         * 到达 deadline 时尚未处理的消息会被直接丢弃；正在执行的消息不受影响。
+         * @return 自退出开始以来累计丢弃的消息数量。
+         */
+        size_t awaitQuit(std::chrono::steady_clock::time_point deadline);
+
         bool isQuitting() const;
 
+        // 队列是否已经彻底退出：消息已全部处理完或被丢弃，next() 将不再返回消息。
+        bool hasQuit() const;
+
+        // 队列存储所在的 NUMA 节点，未绑定节点或绑定失败（例如 cpuset 不允许该节点）时返回 -1
+        int getNumaNode() const;
+
         // Removes messages for a specific handler with a specific 'what' code
         void removeMessages(const std::shared_ptr<Handler>& h, int what);
 
         // Removes callback runnables for a specific handler
         void removeCallbacks(const std::shared_ptr<Handler>& h);
 
+        /**
+         * @brief 在队列中插入一个同步屏障（sync barrier）。
+         *
+         * 屏障生效后，when 晚于屏障时间点的同步消息会被挡住，直到屏障被移除；
+         * 异步消息（Message::async == true）不受影响，可以继续被处理。
+         * 屏障时间点之前已经到期的同步消息仍会照常执行。
+         * @return 用于移除该屏障的 token。
+         */
+        int postSyncBarrier();
+
+        /**
+         * @brief 移除由 postSyncBarrier() 插入的屏障。
+         * @return 如果找到并移除了该屏障返回 true，否则返回 false。
+         */
+        bool removeSyncBarrier(int token);
+
 
     private:
-        std::deque<Message> mMessages;           // Use deque for efficient front removal/insertion
+        struct SyncBarrier {
+            int token;
+            std::chrono::steady_clock::time_point when;
+        };
+
+        using MessageList = std::pmr::deque<Message>;
+
+        // 队列存储的内存来源：绑定 NUMA 节点时为节点本地的内存池，否则为空（使用默认分配器）。
+        // 所有访问都在 mMutex 保护下进行，因此使用非同步的池即可。必须声明在消息队列之前。
+        std::unique_ptr<NumaMemoryResource> mUpstreamResource;
+        std::unique_ptr<std::pmr::unsynchronized_pool_resource> mPoolResource;
+
+        // 同步消息和异步消息分别按 'when' 排序保存，next() 只需比较两个队首，
+        // 即可在有屏障时跳过被挡住的同步消息，而不必遍历整个队列。
+        MessageList mMessages;                   // Use deque for efficient front removal/insertion
+        MessageList mAsyncMessages;              // Messages with async == true
+        std::deque<SyncBarrier> mBarriers;       // Sorted by 'when'; only the front one matters
+        int mNextBarrierToken = 0;
+
+        // 丢弃队列中剩余的所有消息并标记为已退出，返回丢弃数量。调用者必须持有 mMutex。
+        // 被丢弃的消息移入 dropped，由调用者在释放 mMutex 之后析构：消息的回调可能捕获了
+        // 析构时会再次向本队列投递消息的对象，在持锁时析构会自锁。
+        size_t dropAllLocked(std::vector<Message>& dropped);
+
+        // 把 messages 中满足 pred 的消息移入 dropped，其余保持原有顺序。调用者必须持有 mMutex。
+        template <typename Pred>
+        static void extractLocked(MessageList& messages, Pred pred, std::vector<Message>& dropped);
+
+        std::chrono::steady_clock::time_point mQuitDeadline = std::chrono::steady_clock::time_point::max();
+        size_t mDroppedCount = 0;                // Messages dropped since quitting began
+        bool mQuit = false;                      // All messages processed or dropped
+        std::condition_variable mQuitCondVar;    // Signalled when mQuit becomes true
         mutable std::mutex mMutex;
         std::condition_variable mCondVar;
         std::atomic<bool> mQuitting{ false };
@@ -96,7 +181,7 @@ namespace core {
     class Looper {
     private:
         // Private constructor: Use static methods prepare()/myLooper()
-        Looper();
+        explicit Looper(int numaNode = -1);
 
         // Thread-local storage for the Looper instance
         // Each thread gets its own pointer, initialized to nullptr
@@ -111,7 +196,8 @@ namespace core {
         Looper& operator=(const Looper&) = delete;
 
         // Prepares a Looper for the calling thread. Must be called before loop().
-        static void prepare();
+        // If numaNode >= 0, the Looper's queue storage is allocated on that NUMA node.
+        static void prepare(int numaNode = -1);
 
         // Returns the Looper associated with the calling thread.
         // Returns nullptr if Looper::prepare() hasn't been called.
@@ -124,11 +210,30 @@ namespace core {
         // Stops the Looper safely. Can be called from any thread.
         void quit();
 
+        /**
+         * @brief 安全退出 Looper：已经到期的消息会全部处理完，延迟消息被丢弃。可在任意线程调用。
+         * @return 被丢弃的延迟消息数量。
+         */
+        size_t quitSafely();
+
+        /**
+         * @brief 在限定时间内安全退出 Looper。
+         *
+         * 与 quitSafely() 相同，但排空过程最多持续 timeoutMillis 毫秒，到期后剩余消息被丢弃。
+         * 从其他线程调用时会阻塞，直到 Looper 排空或超时；从 Looper 自身线程调用时不会阻塞，
+         * 此时只返回立即丢弃的延迟消息数量。
+         * @return 被丢弃的消息总数。
+         */
+        size_t quitWithin(long timeoutMillis);
+
         // Gets the message queue associated with this Looper.
         // Be cautious when using the queue directly.
         MessageQueue* getQueue() const;
 
         std::thread::id getThreadId() const;
+
+        // 该 Looper 的队列存储所在的 NUMA 节点，未绑定时返回 -1
+        int getNumaNode() const;
     };
 
     // Enables sending and processing Message objects associated with a Looper's MessageQueue
@@ -165,6 +270,7 @@ namespace core {
     private:
         std::shared_ptr<Looper> mLooper;
         MessageQueue* mQueue; // Raw pointer for performance, lifetime managed by Looper
+        bool mAsynchronous = false;
 
     public:
         // Creates a Handler associated with the Looper for the current thread.
@@ -172,7 +278,9 @@ namespace core {
         Handler();
 
         // Creates a Handler associated with a specific Looper.
-        explicit Handler(std::shared_ptr<Looper> looper);
+        // If async is true, every message and runnable sent through this Handler
+        // is marked asynchronous and therefore bypasses sync barriers.
+        explicit Handler(std::shared_ptr<Looper> looper, bool async = false);
 
         virtual ~Handler() = default; // Virtual destructor
 
@@ -194,6 +302,13 @@ namespace core {
         // Sends a Message to be processed at a specific time.
         bool sendMessageAtTime(Message&& msg, std::chrono::steady_clock::time_point uptimeMillis);
 
+        /**
+         * @brief 批量发送消息：所有消息在一次加锁、一次唤醒内入队，并保持原有顺序。
+         * 消息会被移走（与 sendMessage(Message&&) 一致）。
+         * @return 被接受的消息数量；队列正在退出时为 0。
+         */
+        size_t sendMessages(std::span<Message> msgs);
+
         // --- Runnable Posting Methods ---
 
         // Posts a task (std::function) to be run on the Handler's thread.
@@ -229,9 +344,72 @@ namespace core {
         // Removes any pending posts of callbacks (runnables) targeted to this Handler.
         void removeCallbacks();
 
+        // --- Synchronous Invocation Methods ---
+
+        /**
+         * @brief 在 Handler 的线程上执行 fn，并通过 std::future 取得其返回值（或异常）。
+         *
+         * 如果调用者本身就在该 Looper 线程上，fn 会被立即内联执行，返回一个已就绪的 future，
+         * 避免在自己的队列上等待而造成死锁。
+         * 如果队列正在退出，任务不会被执行，future.get() 会抛出 std::future_error (broken_promise)。
+         */
+        template <typename F>
+        auto invoke(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>&>>;
+
+        /**
+         * @brief 在 Handler 的线程上同步执行 fn，并阻塞等待其完成（对应 Android 的 runWithScissors）。
+         *
+         * - 如果调用者已经在该 Looper 线程上，fn 会被内联执行。
+         * - 否则 fn 以引用方式提交，调用线程在一个预先分配、可复用的完成槽上等待，
+         *   不会为 promise/future 的共享状态分配内存。
+         * - fn 抛出的异常会在调用线程上重新抛出。
+         * - 超时或队列退出时，尚未开始执行的 fn 会被取消；若 fn 已经开始执行，则会等待其结束后再返回。
+         * - 如果 fn 在执行前被移出队列（例如 removeCallbacks()），调用会立即返回 false。
+         *
+         * @param timeoutMillis 最长等待时间（毫秒），0 表示无限等待。
+         * @return fn 执行完成返回 true；超时、队列退出或任务被移除返回 false。
+         */
+        template <typename F>
+        bool runSync(F&& fn, long timeoutMillis = 0);
+
         // Gets the Looper associated with this Handler.
         std::shared_ptr<Looper> getLooper() const;
+
+    private:
+        // runSync 使用的每线程完成槽，定义见 looper_handler.cpp
+        struct SyncSlot;
+
+        // runSync 的非模板实现：ctx 指向调用者栈上的 fn，thunk 负责调用它
+        bool runSyncImpl(void* ctx, void (*thunk)(void*), long timeoutMillis);
     };
 
+    // --- Handler 模板成员实现 ---
+
+    template <typename F>
+    auto Handler::invoke(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        std::future<R> future = task->get_future();
+        if (mLooper->getThreadId() == std::this_thread::get_id()) {
+            (*task)();
+        }
+        else {
+            // post 失败时 task 随 lambda 一起销毁，future 会收到 broken_promise
+            post([task]() { (*task)(); });
+        }
+        return future;
+    }
+
+    template <typename F>
+    bool Handler::runSync(F&& fn, long timeoutMillis) {
+        if (mLooper->getThreadId() == std::this_thread::get_id()) {
+            std::forward<F>(fn)();
+            return true;
+        }
+        using Fn = std::remove_reference_t<F>;
+        void* ctx = const_cast<void*>(static_cast<const void*>(std::addressof(fn)));
+        return runSyncImpl(ctx, [](void* p) { (*static_cast<Fn*>(p))(); }, timeoutMillis);
+    }
+
 }
 #endif // LOOPER_HANDLER_H
\ No newline at end of file
@@ -46,6 +46,13 @@ public:
     static const int MSG_TO_BE_REMOVED = 4;
 };
 
+// 一个异步 Handler，通过它发送的消息和任务不受同步屏障影响
+class AsyncTestHandler : public Handler {
+public:
+    explicit AsyncTestHandler(std::shared_ptr<Looper> looper) : Handler(std::move(looper), true) {}
+    void handleMessage(const Message&) override {}
+};
+
 // --- Looper 和 Handler 测试套件 ---
 class LooperHandlerTest : public ::testing::Test {
 protected:
@@ -307,4 +314,258 @@ TEST_F(LooperHandlerTest, PostAtFrontOfQueue) {
     ASSERT_EQ(execution_order.size(), 2);
     EXPECT_EQ(execution_order[0], 1); // 验证高优先级任务先执行
     EXPECT_EQ(execution_order[1], 2); // 验证普通任务后执行
-}
\ No newline at end of file
+}
+
+// 测试 runSync 在 Looper 线程上同步执行任务
+TEST_F(LooperHandlerTest, RunSyncExecutesOnLooperThread) {
+    auto handler = std::make_shared<TestHandler>(background_looper);
+    std::thread::id executed_id;
+
+    ASSERT_TRUE(handler->runSync([&]() {
+        executed_id = std::this_thread::get_id();
+    }));
+
+    // runSync 返回时任务必定已经执行完毕
+    EXPECT_EQ(executed_id, background_looper->getThreadId());
+}
+
+// 测试在 Looper 线程上调用 runSync / invoke 会内联执行，而不是死锁
+TEST_F(LooperHandlerTest, RunSyncAndInvokeInlineOnLooperThread) {
+    auto handler = std::make_shared<TestHandler>(background_looper);
+    std::promise<std::pair<bool, int>> result_promise;
+    auto result_future = result_promise.get_future();
+
+    handler->post([&]() {
+        int value = 0;
+        bool ran = handler->runSync([&]() { value = 1; });
+        auto inner = handler->invoke([&]() { return value + 1; });
+        // invoke 在 Looper 线程上调用时返回已就绪的 future
+        result_promise.set_value({ ran, inner.get() });
+    });
+
+    ASSERT_EQ(result_future.wait_for(1s), std::future_status::ready);
+    auto [ran, value] = result_future.get();
+    EXPECT_TRUE(ran);
+    EXPECT_EQ(value, 2);
+}
+
+// 测试 runSync 超时后返回 false，且被取消的任务不会再执行
+TEST_F(LooperHandlerTest, RunSyncTimeoutCancelsPendingTask) {
+    auto handler = std::make_shared<TestHandler>(background_looper);
+    std::promise<void> release_promise;
+    auto release_future = release_promise.get_future().share();
+
+    // 先让 Looper 线程被一个任务占住
+    handler->post([release_future]() { release_future.wait(); });
+
+    std::atomic<bool> executed = false;
+    EXPECT_FALSE(handler->runSync([&]() { executed = true; }, 50));
+
+    release_promise.set_value();
+    // 再做一次同步调用，保证之前排队的过期任务已经被处理过
+    ASSERT_TRUE(handler->runSync([]() {}));
+    EXPECT_FALSE(executed);
+}
+
+// 测试 runSync 排队中的任务被移除后，无限等待的调用者会立即返回 false
+TEST_F(LooperHandlerTest, RunSyncReturnsWhenTaskIsRemoved) {
+    auto handler = std::make_shared<TestHandler>(background_looper);
+    std::promise<void> release_promise;
+    auto release_future = release_promise.get_future().share();
+    handler->post([release_future]() { release_future.wait(); });
+
+    std::atomic<bool> executed = false;
+    auto result = std::async(std::launch::async, [&]() {
+        return handler->runSync([&]() { executed = true; });
+    });
+
+    // 留出时间让 runSync 的任务入队，此时调用者仍在等待
+    ASSERT_NE(result.wait_for(std::chrono::milliseconds(100)), std::future_status::ready);
+    handler->removeCallbacks();
+    ASSERT_EQ(result.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_FALSE(result.get());
+
+    release_promise.set_value();
+    ASSERT_TRUE(handler->runSync([]() {}));
+    EXPECT_FALSE(executed);
+}
+
+// 测试 runSync 会在调用线程上重新抛出任务中的异常
+TEST_F(LooperHandlerTest, RunSyncPropagatesException) {
+    auto handler = std::make_shared<TestHandler>(background_looper);
+    EXPECT_THROW(handler->runSync([]() { throw std::runtime_error("boom"); }), std::runtime_error);
+    // 异常之后完成槽仍可复用
+    EXPECT_TRUE(handler->runSync([]() {}));
+}
+
+// 测试 invoke 返回任务的结果
+TEST_F(LooperHandlerTest, InvokeReturnsFuture) {
+    auto handler = std::make_shared<TestHandler>(background_looper);
+
+    auto thread_id_future = handler->invoke([]() { return std::this_thread::get_id(); });
+    ASSERT_EQ(thread_id_future.wait_for(1s), std::future_status::ready);
+    EXPECT_EQ(thread_id_future.get(), background_looper->getThreadId());
+
+    auto error_future = handler->invoke([]() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(error_future.get(), std::runtime_error);
+}
+
+// 测试同步屏障：挡住同步消息，放行异步消息，移除后同步消息继续执行
+TEST_F(LooperHandlerTest, SyncBarrierHoldsSyncMessagesButNotAsync) {
+    auto sync_handler = std::make_shared<TestHandler>(background_looper);
+    auto async_handler = std::make_shared<TestHandler>(background_looper);
+    auto async_poster = std::make_shared<AsyncTestHandler>(background_looper);
+    MessageQueue* queue = background_looper->getQueue();
+
+    std::mutex order_mutex;
+    std::vector<int> execution_order;
+    auto record = [&](int id) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        execution_order.push_back(id);
+    };
+
+    int token = queue->postSyncBarrier();
+    // 确保之后发送的消息时间点晚于屏障
+    std::this_thread::sleep_for(1ms);
+
+    sync_handler->post([&]() { record(1); });
+
+    // 通过 Message::async 标记的异步消息
+    std::promise<void> async_done;
+    Message async_msg([&]() { record(2); async_done.set_value(); });
+    async_msg.async = true;
+    ASSERT_TRUE(async_handler->sendMessage(std::move(async_msg)));
+    ASSERT_EQ(async_done.get_future().wait_for(1s), std::future_status::ready);
+
+    // 通过异步 Handler 发送的任务同样可以越过屏障
+    std::promise<void> async_handler_done;
+    async_poster->post([&]() { record(3); async_handler_done.set_value(); });
+    ASSERT_EQ(async_handler_done.get_future().wait_for(1s), std::future_status::ready);
+
+    {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        ASSERT_EQ(execution_order, (std::vector<int>{ 2, 3 }));
+    }
+
+    ASSERT_TRUE(queue->removeSyncBarrier(token));
+    EXPECT_FALSE(queue->removeSyncBarrier(token));
+
+    // 屏障移除后，被挡住的同步任务会执行
+    ASSERT_TRUE(sync_handler->runSync([]() {}));
+    std::lock_guard<std::mutex> lock(order_mutex);
+    EXPECT_EQ(execution_order, (std::vector<int>{ 2, 3, 1 }));
+}
+
+// 测试屏障存在时 postAtFrontOfQueue 的同步任务仍然最先执行，且不会挡住屏障之前的同步消息
+TEST_F(LooperHandlerTest, PostAtFrontOfQueueRunsBeforeBarrier) {
+    auto handler = std::make_shared<TestHandler>(background_looper);
+    MessageQueue* queue = background_looper->getQueue();
+
+    std::mutex order_mutex;
+    std::vector<int> execution_order;
+    auto record = [&](int id) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        execution_order.push_back(id);
+    };
+
+    // 先阻塞 Looper，让后面的消息都留在队列里
+    std::promise<void> blocker_started;
+    std::promise<void> unblock;
+    auto unblocked = unblock.get_future();
+    handler->post([&]() {
+        blocker_started.set_value();
+        unblocked.wait();
+    });
+    blocker_started.get_future().wait();
+
+    handler->post([&]() { record(1); });  // 早于屏障，应当执行
+    std::this_thread::sleep_for(1ms);
+    int token = queue->postSyncBarrier();
+    std::this_thread::sleep_for(1ms);
+    std::promise<void> after_barrier_done;
+    handler->post([&]() { record(3); after_barrier_done.set_value(); });  // 晚于屏障，被挡住
+    std::promise<void> front_done;
+    ASSERT_TRUE(handler->postAtFrontOfQueue([&]() { record(0); front_done.set_value(); }));
+    unblock.set_value();
+
+    ASSERT_EQ(front_done.get_future().wait_for(1s), std::future_status::ready);
+    // 给屏障之前的同步消息留出执行时间
+    std::this_thread::sleep_for(20ms);
+    {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        EXPECT_EQ(execution_order, (std::vector<int>{ 0, 1 }));
+    }
+
+    ASSERT_TRUE(queue->removeSyncBarrier(token));
+    auto after_barrier = after_barrier_done.get_future();
+    ASSERT_EQ(after_barrier.wait_for(1s), std::future_status::ready);
+    std::lock_guard<std::mutex> lock(order_mutex);
+    EXPECT_EQ(execution_order, (std::vector<int>{ 0, 1, 3 }));
+}
+
+// 测试 quitSafely：已到期的消息被处理，延迟消息被丢弃
+TEST_F(LooperHandlerTest, QuitSafelyDrainsDueMessagesAndDropsDelayed) {
+    auto handler = std::make_shared<TestHandler>(background_looper);
+    std::promise<void> release_promise;
+    auto release_future = release_promise.get_future().share();
+    std::atomic<int> executed = 0;
+
+    // 占住 Looper 线程，保证后续消息在 quitSafely 时仍在队列中
+    handler->post([release_future]() { release_future.wait(); });
+    handler->post([&]() { executed++; });
+    handler->post([&]() { executed++; });
+    handler->postDelayed([&]() { executed = -100; }, 10000);
+
+    EXPECT_EQ(background_looper->quitSafely(), 1u);
+    // 退出后不再接受新消息
+    EXPECT_FALSE(handler->post([&]() { executed = -100; }));
+
+    release_promise.set_value();
+    looper_thread->join();
+    EXPECT_EQ(executed, 2);
+    EXPECT_TRUE(background_looper->getQueue()->hasQuit());
+}
+
+// 测试 quitWithin：超过排空时间后剩余消息被丢弃，并返回丢弃数量
+TEST_F(LooperHandlerTest, QuitWithinDropsMessagesAfterDeadline) {
+    auto handler = std::make_shared<TestHandler>(background_looper);
+    std::atomic<int> executed = 0;
+
+    handler->post([&]() { std::this_thread::sleep_for(100ms); executed++; });
+    handler->post([&]() { executed++; });
+    handler->post([&]() { executed++; });
+    handler->postDelayed([&]() { executed++; }, 10000);
+
+    auto start_time = std::chrono::steady_clock::now();
+    size_t dropped = background_looper->quitWithin(20);
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+
+    // 第一个任务仍在执行，后两个到期任务和一个延迟任务都被丢弃
+    EXPECT_EQ(dropped, 3u);
+    EXPECT_LT(elapsed, 90ms);
+
+    looper_thread->join();
+    EXPECT_EQ(executed, 1);
+}
+
+// 测试 sendMessages 批量入队并保持顺序，队列退出后不再接受
+TEST_F(LooperHandlerTest, SendMessagesBatchPreservesOrder) {
+    auto handler = std::make_shared<TestHandler>(background_looper);
+
+    std::vector<Message> batch;
+    for (int i = 0; i < 100; ++i) {
+        batch.emplace_back(i);
+    }
+    EXPECT_EQ(handler->sendMessages(batch), 100u);
+
+    // 同步调用排在批量消息之后，返回时它们都已被处理
+    ASSERT_TRUE(handler->runSync([]() {}));
+    ASSERT_EQ(handler->handled_messages.size(), 100u);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(handler->handled_messages[i], i);
+    }
+
+    background_looper->quit();
+    std::vector<Message> rejected(3);
+    EXPECT_EQ(handler->sendMessages(rejected), 0u);
+}
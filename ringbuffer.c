@@ -1,4 +1,9 @@
  
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* syscall(), MFD_CLOEXEC */
+#endif
+
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -13,6 +18,19 @@
     #endif
 #endif /* USE_MLOCK */
 
+#if defined(__linux__)
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#if defined(SYS_memfd_create)
+		#define RINGBUFFER_HAVE_MEMFD 1
+		#ifndef MFD_CLOEXEC
+			#define MFD_CLOEXEC 0x0001U
+		#endif
+	#endif
+#endif
+
+#include "futex_event.h"
 #include "ringbuffer.h"
  
 
@@ -72,10 +90,94 @@ ringbuffer_create (size_t sz)
 		return NULL;
 	}
 	rb->mlocked = 0;
+	rb->mirrored = 0;
+	rb->map_size = 0;
+	rb->notify = NULL;
 
 	return rb;
 }
 
+#ifdef RINGBUFFER_HAVE_MEMFD
+/* Map the same memfd twice back-to-back at `size' bytes each. Returns
+   the start of the 2*size region or NULL. */
+
+static char *
+ringbuffer_map_mirrored (size_t size)
+{
+	int fd;
+	char *addr;
+
+	fd = (int) syscall (SYS_memfd_create, "ringbuffer", MFD_CLOEXEC);
+	if (fd < 0) {
+		return NULL;
+	}
+	if (ftruncate (fd, (off_t) size) != 0) {
+		close (fd);
+		return NULL;
+	}
+
+	/* reserve the whole range first so both halves are adjacent */
+	addr = (char *) mmap (NULL, 2 * size, PROT_NONE,
+			      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED) {
+		close (fd);
+		return NULL;
+	}
+	if (mmap (addr, size, PROT_READ | PROT_WRITE,
+		  MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+	    || mmap (addr + size, size, PROT_READ | PROT_WRITE,
+		     MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap (addr, 2 * size);
+		close (fd);
+		return NULL;
+	}
+
+	/* the mappings keep the memory alive */
+	close (fd);
+	return addr;
+}
+#endif /* RINGBUFFER_HAVE_MEMFD */
+
+/* Create a ringbuffer whose data block is mapped twice in a row, so
+   that buf[i] and buf[i + size] are the same byte. Readable and
+   writeable regions are then always a single contiguous segment.
+   The size is rounded up to a power of two that is at least one page.
+   Falls back to ringbuffer_create() (mirrored == 0) when the platform
+   cannot double-map memory. */
+
+ringbuffer_t *
+ringbuffer_create_mirrored (size_t sz)
+{
+#ifdef RINGBUFFER_HAVE_MEMFD
+	ringbuffer_t *rb;
+	size_t size;
+	long page;
+	char *buf;
+
+	page = sysconf (_SC_PAGESIZE);
+	for (size = page > 0 ? (size_t) page : 4096; size < sz; size <<= 1);
+
+	buf = ringbuffer_map_mirrored (size);
+	if (buf != NULL) {
+		if ((rb = (ringbuffer_t *) malloc (sizeof (ringbuffer_t))) == NULL) {
+			munmap (buf, 2 * size);
+			return NULL;
+		}
+		rb->buf = buf;
+		rb->size = size;
+		rb->size_mask = size - 1;
+		rb->write_ptr = 0;
+		rb->read_ptr = 0;
+		rb->mlocked = 0;
+		rb->mirrored = 1;
+		rb->map_size = size;
+		rb->notify = NULL;
+		return rb;
+	}
+#endif /* RINGBUFFER_HAVE_MEMFD */
+	return ringbuffer_create (sz);
+}
+
 /* Free all data associated with the ringbuffer `rb'. */
 
 void
@@ -88,10 +190,18 @@ ringbuffer_destroy (ringbuffer_t * rb)
             VirtualUnlock(rb->buf, rb->size);
         #else
             // POSIX implementation using munlock
-            munlock(rb->buf, rb->size);
+            munlock(rb->buf, rb->mirrored ? rb->map_size : rb->size);
         #endif
 	}
 #endif /* USE_MLOCK */
+	free (rb->notify);
+#ifdef RINGBUFFER_HAVE_MEMFD
+	if (rb->mirrored) {
+		munmap (rb->buf, 2 * rb->map_size);
+		free (rb);
+		return;
+	}
+#endif
 	free (rb->buf);
 	free (rb);
 }
@@ -110,7 +220,7 @@ ringbuffer_mlock (ringbuffer_t * rb)
         }
     #else
         // POSIX implementation using mlock
-        if (mlock(rb->buf, rb->size)) {
+        if (mlock(rb->buf, rb->mirrored ? rb->map_size : rb->size)) {
             return -1;
         }
     #endif
@@ -141,6 +251,10 @@ ringbuffer_reset_size (ringbuffer_t * rb, size_t sz)
     rb->size_mask -= 1;
     rb->read_ptr = 0;
     rb->write_ptr = 0;
+    /* a shrunk mirrored buffer no longer wraps at the mirror boundary */
+    if (rb->map_size) {
+        rb->mirrored = (sz == rb->map_size);
+    }
 }
 
 /* Return the number of bytes available for reading.  This is the
@@ -196,7 +310,7 @@ ringbuffer_get (ringbuffer_t * rb, char *dest, size_t cnt)
 	 * modified from writing thread  */
 	cnt2 = rb->read_ptr + to_read;
 
-	if (cnt2 > rb->size) {
+	if (cnt2 > rb->size && !rb->mirrored) {
 		n1 = rb->size - rb->read_ptr;
 		n2 = cnt2 & rb->size_mask;
 	} else {
@@ -240,7 +354,7 @@ ringbuffer_peek (ringbuffer_t * rb, char *dest, size_t cnt)
 
 	cnt2 = tmp_read_ptr + to_read;
 
-	if (cnt2 > rb->size) {
+	if (cnt2 > rb->size && !rb->mirrored) {
 		n1 = rb->size - tmp_read_ptr;
 		n2 = cnt2 & rb->size_mask;
 	} else {
@@ -279,7 +393,7 @@ ringbuffer_put (ringbuffer_t * rb, const char *src, size_t cnt)
 	 * modified from reading thread  */
 	cnt2 = rb->write_ptr + to_write;
 
-	if (cnt2 > rb->size) {
+	if (cnt2 > rb->size && !rb->mirrored) {
 		n1 = rb->size - rb->write_ptr;
 		n2 = cnt2 & rb->size_mask;
 	} else {
@@ -297,6 +411,9 @@ ringbuffer_put (ringbuffer_t * rb, const char *src, size_t cnt)
 		rb->write_ptr = (rb->write_ptr + n2) & rb->size_mask;
 	}
 
+	if (rb->notify) {
+		futex_event_signal (rb->notify);
+	}
 	return to_write;
 }
 
@@ -318,12 +435,15 @@ ringbuffer_write_advance (ringbuffer_t * rb, size_t cnt)
 	size_t tmp = (rb->write_ptr + cnt) & rb->size_mask;
 	JACK_REL_FENCE(); /* ensure pointer increment happens after copy (by user) */
 	rb->write_ptr = tmp;
+	if (rb->notify) {
+		futex_event_signal (rb->notify);
+	}
 }
 
 /* The non-copying data reader.  `vec' is an array of two places.  Set
    the values at `vec' to hold the current readable data at `rb'.  If
    the readable data is in one segment the second segment has zero
-   length.  */
+   length. A mirrored ringbuffer always returns a single segment.  */
 
 void
 ringbuffer_get_read_vector (const ringbuffer_t * rb,
@@ -337,7 +457,7 @@ ringbuffer_get_read_vector (const ringbuffer_t * rb,
 	free_cnt = ringbuffer_read_space(rb);
 	cnt2 = r + free_cnt;
 
-	if (cnt2 > rb->size) {
+	if (cnt2 > rb->size && !rb->mirrored) {
 
 		/* Two part vector: the rest of the buffer after the current write
 		   ptr, plus some from the start of the buffer. */
@@ -360,7 +480,7 @@ ringbuffer_get_read_vector (const ringbuffer_t * rb,
 /* The non-copying data writer.  `vec' is an array of two places.  Set
    the values at `vec' to hold the current writeable data at `rb'.  If
    the writeable data is in one segment the second segment has zero
-   length.  */
+   length. A mirrored ringbuffer always returns a single segment.  */
 
 void
 ringbuffer_get_write_vector (const ringbuffer_t * rb,
@@ -374,7 +494,7 @@ ringbuffer_get_write_vector (const ringbuffer_t * rb,
 	free_cnt = ringbuffer_write_space(rb);
 	cnt2 = w + free_cnt;
 
-	if (cnt2 > rb->size) {
+	if (cnt2 > rb->size && !rb->mirrored) {
 
 		/* Two part vector: the rest of the buffer after the current write
 		   ptr, plus some from the start of the buffer. */
@@ -395,3 +515,728 @@ ringbuffer_is_empty(const ringbuffer_t *ring_buf)
 {
 	return ring_buf->read_ptr == ring_buf->write_ptr;
 }
+
+/* Allow a reader to sleep in ringbuffer_wait_read(). Call before the
+   reader and writer threads start. Afterwards ringbuffer_put() and
+   ringbuffer_write_advance() wake a sleeping reader; when nobody waits
+   they cost one fence and one load, no syscall. */
+
+int
+ringbuffer_enable_wait (ringbuffer_t * rb)
+{
+	if (rb->notify) {
+		return 0;
+	}
+	if ((rb->notify = (struct futex_event *) malloc (sizeof (struct futex_event))) == NULL) {
+		return -1;
+	}
+	futex_event_init (rb->notify);
+	return 0;
+}
+
+struct ringbuffer_wait_ctx {
+	const ringbuffer_t *rb;
+	size_t min_bytes;
+};
+
+static bool
+ringbuffer_can_read_min (void *ctx)
+{
+	struct ringbuffer_wait_ctx *wait = (struct ringbuffer_wait_ctx *) ctx;
+	return ringbuffer_read_space (wait->rb) >= wait->min_bytes;
+}
+
+/* Block the reader until at least `min_bytes' are readable or
+   `timeout_ms' elapses (negative: no timeout). Returns the readable byte
+   count, which is below `min_bytes' only on timeout. Without
+   ringbuffer_enable_wait() it does not block. */
+
+size_t
+ringbuffer_wait_read (ringbuffer_t * rb, size_t min_bytes, int timeout_ms)
+{
+	struct ringbuffer_wait_ctx ctx;
+
+	if (rb->notify) {
+		ctx.rb = rb;
+		ctx.min_bytes = min_bytes;
+		futex_event_wait_until (rb->notify, ringbuffer_can_read_min, &ctx, timeout_ms);
+	}
+	return ringbuffer_read_space (rb);
+}
+
+
+/*
+ * ringbuffer_spsc_t: same single-producer/single-consumer byte ring, but
+ * with C11 atomic indices instead of fences around plain size_t, each
+ * index on its own cache line together with the owner's cached copy of
+ * the opposite index. The producer only re-reads read_idx (and so only
+ * pulls the consumer's cache line) when its cached value says the ring
+ * is full, and vice versa.
+ *
+ * The indices are free-running and masked on access, so all `size'
+ * bytes are usable.
+ */
+
+#define RINGBUFFER_CACHE_LINE 64
+
+struct ringbuffer_spsc {
+	/* producer side */
+	_Alignas(RINGBUFFER_CACHE_LINE) _Atomic size_t write_idx;
+	size_t read_cache;	/* last read_idx seen by the producer */
+
+	/* consumer side */
+	_Alignas(RINGBUFFER_CACHE_LINE) _Atomic size_t read_idx;
+	size_t write_cache;	/* last write_idx seen by the consumer */
+
+	/* read-only while producer and consumer are running */
+	_Alignas(RINGBUFFER_CACHE_LINE) char *buf;
+	size_t size;
+	size_t size_mask;
+	size_t alloc_size;
+	int mlocked;
+};
+
+/* `size' must be a multiple of RINGBUFFER_CACHE_LINE */
+
+static void *
+ringbuffer_aligned_alloc (size_t size)
+{
+#ifdef _MSC_VER
+	return _aligned_malloc (size, RINGBUFFER_CACHE_LINE);
+#else
+	return aligned_alloc (RINGBUFFER_CACHE_LINE, size);
+#endif
+}
+
+static void
+ringbuffer_aligned_free (void *p)
+{
+#ifdef _MSC_VER
+	_aligned_free (p);
+#else
+	free (p);
+#endif
+}
+
+static int
+ringbuffer_is_power_of_two (size_t sz)
+{
+	return sz != 0 && (sz & (sz - 1)) == 0;
+}
+
+ringbuffer_spsc_t *
+ringbuffer_spsc_create (size_t sz)
+{
+	ringbuffer_spsc_t *rb;
+	size_t size;
+
+	for (size = 2; size < sz; size <<= 1);
+
+	rb = (ringbuffer_spsc_t *) ringbuffer_aligned_alloc (sizeof (ringbuffer_spsc_t));
+	if (rb == NULL) {
+		return NULL;
+	}
+	if ((rb->buf = (char *) malloc (size)) == NULL) {
+		ringbuffer_aligned_free (rb);
+		return NULL;
+	}
+	rb->size = size;
+	rb->size_mask = size - 1;
+	rb->alloc_size = size;
+	rb->mlocked = 0;
+	atomic_init (&rb->write_idx, 0);
+	atomic_init (&rb->read_idx, 0);
+	rb->read_cache = 0;
+	rb->write_cache = 0;
+
+	return rb;
+}
+
+void
+ringbuffer_spsc_destroy (ringbuffer_spsc_t * rb)
+{
+#ifdef USE_MLOCK
+	if (rb->mlocked) {
+        #ifdef _MSC_VER
+            VirtualUnlock(rb->buf, rb->alloc_size);
+        #else
+            munlock(rb->buf, rb->alloc_size);
+        #endif
+	}
+#endif /* USE_MLOCK */
+	free (rb->buf);
+	ringbuffer_aligned_free (rb);
+}
+
+int
+ringbuffer_spsc_mlock (ringbuffer_spsc_t * rb)
+{
+#ifdef USE_MLOCK
+    #ifdef _MSC_VER
+        if (!VirtualLock(rb->buf, rb->alloc_size)) {
+            return -1;
+        }
+    #else
+        if (mlock(rb->buf, rb->alloc_size)) {
+            return -1;
+        }
+    #endif
+#endif /* USE_MLOCK */
+	rb->mlocked = 1;
+	return 0;
+}
+
+size_t
+ringbuffer_spsc_size (const ringbuffer_spsc_t * rb)
+{
+	return rb->size;
+}
+
+/* Reset to empty. Not thread safe. */
+
+void
+ringbuffer_spsc_reset (ringbuffer_spsc_t * rb)
+{
+	atomic_store_explicit (&rb->write_idx, 0, memory_order_relaxed);
+	atomic_store_explicit (&rb->read_idx, 0, memory_order_relaxed);
+	rb->read_cache = 0;
+	rb->write_cache = 0;
+}
+
+/* Reset to empty and use only the first `sz' bytes of the buffer.
+   Returns -1 (and changes nothing) unless `sz' is a power of two no
+   larger than the allocated size. Not thread safe. */
+
+int
+ringbuffer_spsc_reset_size (ringbuffer_spsc_t * rb, size_t sz)
+{
+	if (!ringbuffer_is_power_of_two (sz) || sz > rb->alloc_size) {
+		return -1;
+	}
+	rb->size = sz;
+	rb->size_mask = sz - 1;
+	ringbuffer_spsc_reset (rb);
+	return 0;
+}
+
+/* Consumer side: bytes available for reading. */
+
+size_t
+ringbuffer_spsc_read_space (ringbuffer_spsc_t * rb)
+{
+	size_t r = atomic_load_explicit (&rb->read_idx, memory_order_relaxed);
+	rb->write_cache = atomic_load_explicit (&rb->write_idx, memory_order_acquire);
+	return rb->write_cache - r;
+}
+
+/* Producer side: bytes available for writing. */
+
+size_t
+ringbuffer_spsc_write_space (ringbuffer_spsc_t * rb)
+{
+	size_t w = atomic_load_explicit (&rb->write_idx, memory_order_relaxed);
+	rb->read_cache = atomic_load_explicit (&rb->read_idx, memory_order_acquire);
+	return rb->size - (w - rb->read_cache);
+}
+
+/* Readable bytes, touching the producer's cache line only when the
+   cached write index does not already cover `wanted'. */
+
+static size_t
+ringbuffer_spsc_readable (ringbuffer_spsc_t * rb, size_t r, size_t wanted)
+{
+	size_t avail = rb->write_cache - r;
+	if (avail < wanted) {
+		rb->write_cache = atomic_load_explicit (&rb->write_idx, memory_order_acquire);
+		avail = rb->write_cache - r;
+	}
+	return avail;
+}
+
+static size_t
+ringbuffer_spsc_writable (ringbuffer_spsc_t * rb, size_t w, size_t wanted)
+{
+	size_t avail = rb->size - (w - rb->read_cache);
+	if (avail < wanted) {
+		rb->read_cache = atomic_load_explicit (&rb->read_idx, memory_order_acquire);
+		avail = rb->size - (w - rb->read_cache);
+	}
+	return avail;
+}
+
+static void
+ringbuffer_spsc_copy_out (const ringbuffer_spsc_t * rb, size_t r,
+			  char *dest, size_t cnt)
+{
+	size_t off = r & rb->size_mask;
+	size_t n1 = rb->size - off;
+
+	if (n1 >= cnt) {
+		memcpy (dest, rb->buf + off, cnt);
+	} else {
+		memcpy (dest, rb->buf + off, n1);
+		memcpy (dest + n1, rb->buf, cnt - n1);
+	}
+}
+
+size_t
+ringbuffer_spsc_get (ringbuffer_spsc_t * rb, char *dest, size_t cnt)
+{
+	size_t r = atomic_load_explicit (&rb->read_idx, memory_order_relaxed);
+	size_t avail = ringbuffer_spsc_readable (rb, r, cnt);
+	size_t to_read = cnt > avail ? avail : cnt;
+
+	if (to_read == 0) {
+		return 0;
+	}
+	ringbuffer_spsc_copy_out (rb, r, dest, to_read);
+	atomic_store_explicit (&rb->read_idx, r + to_read, memory_order_release);
+	return to_read;
+}
+
+size_t
+ringbuffer_spsc_peek (ringbuffer_spsc_t * rb, char *dest, size_t cnt)
+{
+	size_t r = atomic_load_explicit (&rb->read_idx, memory_order_relaxed);
+	size_t avail = ringbuffer_spsc_readable (rb, r, cnt);
+	size_t to_read = cnt > avail ? avail : cnt;
+
+	if (to_read == 0) {
+		return 0;
+	}
+	ringbuffer_spsc_copy_out (rb, r, dest, to_read);
+	return to_read;
+}
+
+size_t
+ringbuffer_spsc_put (ringbuffer_spsc_t * rb, const char *src, size_t cnt)
+{
+	size_t w = atomic_load_explicit (&rb->write_idx, memory_order_relaxed);
+	size_t avail = ringbuffer_spsc_writable (rb, w, cnt);
+	size_t to_write = cnt > avail ? avail : cnt;
+	size_t off, n1;
+
+	if (to_write == 0) {
+		return 0;
+	}
+	off = w & rb->size_mask;
+	n1 = rb->size - off;
+	if (n1 >= to_write) {
+		memcpy (rb->buf + off, src, to_write);
+	} else {
+		memcpy (rb->buf + off, src, n1);
+		memcpy (rb->buf, src + n1, to_write - n1);
+	}
+	atomic_store_explicit (&rb->write_idx, w + to_write, memory_order_release);
+	return to_write;
+}
+
+void
+ringbuffer_spsc_read_advance (ringbuffer_spsc_t * rb, size_t cnt)
+{
+	size_t r = atomic_load_explicit (&rb->read_idx, memory_order_relaxed);
+	atomic_store_explicit (&rb->read_idx, r + cnt, memory_order_release);
+}
+
+void
+ringbuffer_spsc_write_advance (ringbuffer_spsc_t * rb, size_t cnt)
+{
+	size_t w = atomic_load_explicit (&rb->write_idx, memory_order_relaxed);
+	atomic_store_explicit (&rb->write_idx, w + cnt, memory_order_release);
+}
+
+/* Describe `len' bytes starting at free-running index `idx' as up to
+   two segments of `buf'. */
+
+static void
+ringbuffer_spsc_vector_of (char *buf, size_t size, size_t size_mask,
+			   size_t idx, size_t len, ringbuffer_data_t * vec)
+{
+	size_t off = idx & size_mask;
+	size_t n1 = size - off;
+
+	vec[0].buf = buf + off;
+	if (n1 >= len) {
+		vec[0].len = len;
+		vec[1].buf = buf;
+		vec[1].len = 0;
+	} else {
+		vec[0].len = n1;
+		vec[1].buf = buf;
+		vec[1].len = len - n1;
+	}
+}
+
+/* Consumer side: zero-copy view of all readable data, in up to two
+   segments. Follow with ringbuffer_spsc_read_advance(). */
+
+void
+ringbuffer_spsc_get_read_vector (ringbuffer_spsc_t * rb, ringbuffer_data_t * vec)
+{
+	size_t r = atomic_load_explicit (&rb->read_idx, memory_order_relaxed);
+	ringbuffer_spsc_vector_of (rb->buf, rb->size, rb->size_mask, r,
+				   ringbuffer_spsc_read_space (rb), vec);
+}
+
+/* Producer side: zero-copy view of all writeable space, in up to two
+   segments. Follow with ringbuffer_spsc_write_advance(). */
+
+void
+ringbuffer_spsc_get_write_vector (ringbuffer_spsc_t * rb, ringbuffer_data_t * vec)
+{
+	size_t w = atomic_load_explicit (&rb->write_idx, memory_order_relaxed);
+	ringbuffer_spsc_vector_of (rb->buf, rb->size, rb->size_mask, w,
+				   ringbuffer_spsc_write_space (rb), vec);
+}
+
+
+/*
+ * ringbuffer_bcast_t: one writer, up to max_readers readers, each with
+ * its own cursor into the same data block.
+ *
+ * RINGBUFFER_BCAST_BLOCK: the writer's free space is bounded by the
+ * slowest active reader, nobody loses data.
+ * RINGBUFFER_BCAST_OVERRUN: the writer never waits. It announces the
+ * region it is about to overwrite in write_claim before copying (seqlock
+ * style); a reader that finds its data overwritten, either before or
+ * during its copy, skips to the live edge and records the lost bytes.
+ */
+
+struct ringbuffer_bcast_reader {
+	_Alignas(RINGBUFFER_CACHE_LINE) _Atomic size_t read_idx;
+	_Atomic int active;
+	size_t write_cache;	/* last write_idx seen by this reader */
+	size_t lost;		/* bytes skipped, reported by ringbuffer_bcast_overrun */
+};
+
+struct ringbuffer_bcast {
+	/* writer side */
+	_Alignas(RINGBUFFER_CACHE_LINE) _Atomic size_t write_idx;
+	_Atomic size_t write_claim;	/* end of the region being written */
+	size_t read_floor;	/* slowest reader cursor seen by the writer */
+
+	/* read-only while running */
+	_Alignas(RINGBUFFER_CACHE_LINE) char *buf;
+	size_t size;
+	size_t size_mask;
+	int max_readers;
+	ringbuffer_bcast_policy_t policy;
+	struct ringbuffer_bcast_reader *readers;
+};
+
+ringbuffer_bcast_t *
+ringbuffer_bcast_create (size_t sz, int max_readers,
+			 ringbuffer_bcast_policy_t policy)
+{
+	ringbuffer_bcast_t *rb;
+	size_t size;
+	int i;
+
+	if (max_readers <= 0) {
+		return NULL;
+	}
+	for (size = 2; size < sz; size <<= 1);
+
+	rb = (ringbuffer_bcast_t *) ringbuffer_aligned_alloc (sizeof (ringbuffer_bcast_t));
+	if (rb == NULL) {
+		return NULL;
+	}
+	rb->readers = (struct ringbuffer_bcast_reader *) ringbuffer_aligned_alloc (
+		sizeof (struct ringbuffer_bcast_reader) * (size_t) max_readers);
+	rb->buf = (char *) malloc (size);
+	if (rb->readers == NULL || rb->buf == NULL) {
+		ringbuffer_aligned_free (rb->readers);
+		free (rb->buf);
+		ringbuffer_aligned_free (rb);
+		return NULL;
+	}
+
+	rb->size = size;
+	rb->size_mask = size - 1;
+	rb->max_readers = max_readers;
+	rb->policy = policy;
+	rb->read_floor = 0;
+	atomic_init (&rb->write_idx, 0);
+	atomic_init (&rb->write_claim, 0);
+	for (i = 0; i < max_readers; i++) {
+		atomic_init (&rb->readers[i].read_idx, 0);
+		atomic_init (&rb->readers[i].active, 0);
+		rb->readers[i].write_cache = 0;
+		rb->readers[i].lost = 0;
+	}
+	return rb;
+}
+
+void
+ringbuffer_bcast_destroy (ringbuffer_bcast_t * rb)
+{
+	free (rb->buf);
+	ringbuffer_aligned_free (rb->readers);
+	ringbuffer_aligned_free (rb);
+}
+
+size_t
+ringbuffer_bcast_size (const ringbuffer_bcast_t * rb)
+{
+	return rb->size;
+}
+
+/* Register a reader starting at the current write position. Returns the
+   reader id or -1 if all slots are taken. In BLOCK mode call this while
+   the writer is idle, otherwise the writer may not yet account for the
+   new cursor. Not safe against concurrent add_reader calls. */
+
+int
+ringbuffer_bcast_add_reader (ringbuffer_bcast_t * rb)
+{
+	int i;
+
+	for (i = 0; i < rb->max_readers; i++) {
+		struct ringbuffer_bcast_reader *reader = &rb->readers[i];
+		if (!atomic_load_explicit (&reader->active, memory_order_acquire)) {
+			size_t w = atomic_load_explicit (&rb->write_idx, memory_order_acquire);
+			atomic_store_explicit (&reader->read_idx, w, memory_order_relaxed);
+			reader->write_cache = w;
+			reader->lost = 0;
+			atomic_store_explicit (&reader->active, 1, memory_order_release);
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* Unregister a reader; the writer stops waiting for it. */
+
+void
+ringbuffer_bcast_remove_reader (ringbuffer_bcast_t * rb, int reader)
+{
+	atomic_store_explicit (&rb->readers[reader].active, 0, memory_order_release);
+}
+
+/* Writer side: lowest cursor of all active readers, or `w' if none. */
+
+static size_t
+ringbuffer_bcast_scan_floor (ringbuffer_bcast_t * rb, size_t w)
+{
+	size_t floor = w;
+	int i;
+
+	for (i = 0; i < rb->max_readers; i++) {
+		struct ringbuffer_bcast_reader *reader = &rb->readers[i];
+		if (atomic_load_explicit (&reader->active, memory_order_acquire)) {
+			size_t r = atomic_load_explicit (&reader->read_idx, memory_order_acquire);
+			if (w - r > w - floor) {
+				floor = r;
+			}
+		}
+	}
+	rb->read_floor = floor;
+	return floor;
+}
+
+static size_t
+ringbuffer_bcast_writable (ringbuffer_bcast_t * rb, size_t w, size_t wanted)
+{
+	size_t avail;
+
+	if (rb->policy == RINGBUFFER_BCAST_OVERRUN) {
+		return rb->size;
+	}
+	/* reader cursors only move forward, so a stale floor is conservative */
+	avail = rb->size - (w - rb->read_floor);
+	if (avail < wanted) {
+		avail = rb->size - (w - ringbuffer_bcast_scan_floor (rb, w));
+	}
+	return avail;
+}
+
+size_t
+ringbuffer_bcast_write_space (ringbuffer_bcast_t * rb)
+{
+	size_t w = atomic_load_explicit (&rb->write_idx, memory_order_relaxed);
+	return ringbuffer_bcast_writable (rb, w, rb->size);
+}
+
+/* Writer side: announce that [w, w + cnt) is about to be overwritten.
+   The release fence keeps the claim ahead of the data stores, matching
+   the acquire fence readers issue before re-checking it. */
+
+static void
+ringbuffer_bcast_claim (ringbuffer_bcast_t * rb, size_t w, size_t cnt)
+{
+	if (rb->policy == RINGBUFFER_BCAST_OVERRUN) {
+		atomic_store_explicit (&rb->write_claim, w + cnt, memory_order_relaxed);
+		atomic_thread_fence (memory_order_release);
+	}
+}
+
+size_t
+ringbuffer_bcast_put (ringbuffer_bcast_t * rb, const char *src, size_t cnt)
+{
+	size_t w = atomic_load_explicit (&rb->write_idx, memory_order_relaxed);
+	size_t avail = ringbuffer_bcast_writable (rb, w, cnt);
+	size_t to_write = cnt > avail ? avail : cnt;
+	size_t off, n1;
+
+	if (to_write == 0) {
+		return 0;
+	}
+	ringbuffer_bcast_claim (rb, w, to_write);
+	off = w & rb->size_mask;
+	n1 = rb->size - off;
+	if (n1 >= to_write) {
+		memcpy (rb->buf + off, src, to_write);
+	} else {
+		memcpy (rb->buf + off, src, n1);
+		memcpy (rb->buf, src + n1, to_write - n1);
+	}
+	atomic_store_explicit (&rb->write_idx, w + to_write, memory_order_release);
+	return to_write;
+}
+
+/* Writer side zero-copy: reserve up to `max' bytes in up to two
+   segments and return the reserved length. Publish with
+   ringbuffer_bcast_write_advance(). */
+
+size_t
+ringbuffer_bcast_get_write_vector (ringbuffer_bcast_t * rb, size_t max,
+				   ringbuffer_data_t * vec)
+{
+	size_t w = atomic_load_explicit (&rb->write_idx, memory_order_relaxed);
+	size_t avail = ringbuffer_bcast_writable (rb, w, max);
+	size_t len = max > avail ? avail : max;
+
+	ringbuffer_bcast_claim (rb, w, len);
+	ringbuffer_spsc_vector_of (rb->buf, rb->size, rb->size_mask, w, len, vec);
+	return len;
+}
+
+void
+ringbuffer_bcast_write_advance (ringbuffer_bcast_t * rb, size_t cnt)
+{
+	size_t w = atomic_load_explicit (&rb->write_idx, memory_order_relaxed);
+	atomic_store_explicit (&rb->write_idx, w + cnt, memory_order_release);
+}
+
+/* Reader side: refresh the cached write index and, in OVERRUN mode, skip
+   to the live edge if the writer has lapped this reader. Returns the
+   reader's cursor. */
+
+static size_t
+ringbuffer_bcast_sync (ringbuffer_bcast_t * rb, struct ringbuffer_bcast_reader *reader)
+{
+	size_t r = atomic_load_explicit (&reader->read_idx, memory_order_relaxed);
+
+	reader->write_cache = atomic_load_explicit (&rb->write_idx, memory_order_acquire);
+	if (rb->policy == RINGBUFFER_BCAST_OVERRUN
+	    && atomic_load_explicit (&rb->write_claim, memory_order_relaxed) - r > rb->size) {
+		reader->lost += reader->write_cache - r;
+		r = reader->write_cache;
+		atomic_store_explicit (&reader->read_idx, r, memory_order_release);
+	}
+	return r;
+}
+
+/* Reader side, OVERRUN mode: after copying data starting at `r' make
+   sure the writer did not start overwriting it meanwhile. On failure the reader
+   is moved to the live edge and the bytes are counted as lost. */
+
+static int
+ringbuffer_bcast_validate (ringbuffer_bcast_t * rb, struct ringbuffer_bcast_reader *reader,
+			   size_t r)
+{
+	size_t w;
+
+	if (rb->policy != RINGBUFFER_BCAST_OVERRUN) {
+		return 0;
+	}
+	atomic_thread_fence (memory_order_acquire);
+	if (atomic_load_explicit (&rb->write_claim, memory_order_relaxed) - r <= rb->size) {
+		return 0;
+	}
+	w = atomic_load_explicit (&rb->write_idx, memory_order_acquire);
+	reader->lost += w - r;
+	reader->write_cache = w;
+	atomic_store_explicit (&reader->read_idx, w, memory_order_release);
+	return -1;
+}
+
+size_t
+ringbuffer_bcast_read_space (ringbuffer_bcast_t * rb, int reader)
+{
+	struct ringbuffer_bcast_reader *rd = &rb->readers[reader];
+	size_t r = ringbuffer_bcast_sync (rb, rd);
+	return rd->write_cache - r;
+}
+
+size_t
+ringbuffer_bcast_get (ringbuffer_bcast_t * rb, int reader, char *dest, size_t cnt)
+{
+	struct ringbuffer_bcast_reader *rd = &rb->readers[reader];
+	size_t r = atomic_load_explicit (&rd->read_idx, memory_order_relaxed);
+	size_t avail = rd->write_cache - r;
+	size_t to_read, off, n1;
+
+	if (avail < cnt || rb->policy == RINGBUFFER_BCAST_OVERRUN) {
+		r = ringbuffer_bcast_sync (rb, rd);
+		avail = rd->write_cache - r;
+	}
+	to_read = cnt > avail ? avail : cnt;
+	if (to_read == 0) {
+		return 0;
+	}
+
+	off = r & rb->size_mask;
+	n1 = rb->size - off;
+	if (n1 >= to_read) {
+		memcpy (dest, rb->buf + off, to_read);
+	} else {
+		memcpy (dest, rb->buf + off, n1);
+		memcpy (dest + n1, rb->buf, to_read - n1);
+	}
+	if (ringbuffer_bcast_validate (rb, rd, r) != 0) {
+		return 0;
+	}
+	atomic_store_explicit (&rd->read_idx, r + to_read, memory_order_release);
+	return to_read;
+}
+
+/* Reader side zero-copy view of all readable data, in up to two
+   segments. Follow with ringbuffer_bcast_read_advance(). */
+
+void
+ringbuffer_bcast_get_read_vector (ringbuffer_bcast_t * rb, int reader,
+				  ringbuffer_data_t * vec)
+{
+	struct ringbuffer_bcast_reader *rd = &rb->readers[reader];
+	size_t r = ringbuffer_bcast_sync (rb, rd);
+	ringbuffer_spsc_vector_of (rb->buf, rb->size, rb->size_mask, r,
+				   rd->write_cache - r, vec);
+}
+
+/* Release `cnt' bytes obtained from ringbuffer_bcast_get_read_vector().
+   Returns 0, or -1 in OVERRUN mode if the writer overwrote them while
+   they were being read; the data must then be discarded. */
+
+int
+ringbuffer_bcast_read_advance (ringbuffer_bcast_t * rb, int reader, size_t cnt)
+{
+	struct ringbuffer_bcast_reader *rd = &rb->readers[reader];
+	size_t r = atomic_load_explicit (&rd->read_idx, memory_order_relaxed);
+
+	if (ringbuffer_bcast_validate (rb, rd, r) != 0) {
+		return -1;
+	}
+	atomic_store_explicit (&rd->read_idx, r + cnt, memory_order_release);
+	return 0;
+}
+
+/* Reader side: bytes this reader lost to overruns since the last call. */
+
+size_t
+ringbuffer_bcast_overrun (ringbuffer_bcast_t * rb, int reader)
+{
+	size_t lost = rb->readers[reader].lost;
+	rb->readers[reader].lost = 0;
+	return lost;
+}
@@ -1,5 +1,8 @@
 #ifndef __RINGBUFFER_H
 #define	__RINGBUFFER_H
+
+#include <stddef.h>
+
 #if defined (__cplusplus)
 extern "C" {
 #endif
@@ -10,6 +13,8 @@ typedef struct {
 }
 ringbuffer_data_t ;
 
+struct futex_event;
+
 typedef struct {
     char	*buf;
     size_t	write_ptr;
@@ -17,10 +22,14 @@ typedef struct {
     size_t	size;
     size_t	size_mask;
     int	mlocked;
+    int	mirrored;	/* buf[i] and buf[i + size] alias, see ringbuffer_create_mirrored */
+    size_t	map_size;	/* size of one half of the mirrored mapping, 0 if not mirrored */
+    struct futex_event	*notify;	/* set by ringbuffer_enable_wait */
 }
 ringbuffer_t ;
 
 ringbuffer_t *ringbuffer_create(size_t sz);
+ringbuffer_t *ringbuffer_create_mirrored(size_t sz);
 void ringbuffer_destroy(ringbuffer_t *rb);
 void ringbuffer_get_read_vector(const ringbuffer_t *rb,
                                          ringbuffer_data_t *vec);
@@ -38,6 +47,67 @@ size_t ringbuffer_put(ringbuffer_t *rb, const char *src,
 void ringbuffer_write_advance(ringbuffer_t *rb, size_t cnt);
 size_t ringbuffer_write_space(const ringbuffer_t *rb);
 int ringbuffer_is_empty(const ringbuffer_t *ring_buf);
+int ringbuffer_enable_wait(ringbuffer_t *rb);
+size_t ringbuffer_wait_read(ringbuffer_t *rb, size_t min_bytes, int timeout_ms);
+
+/*
+ * Single-producer/single-consumer ring with C11 atomic indices kept on
+ * separate cache lines and cached opposite indices. Opaque; all `size'
+ * bytes are usable. read_space/get/peek/read_advance/get_read_vector
+ * belong to the consumer thread, the rest of the data functions to the
+ * producer thread.
+ */
+typedef struct ringbuffer_spsc ringbuffer_spsc_t;
+
+ringbuffer_spsc_t *ringbuffer_spsc_create(size_t sz);
+void ringbuffer_spsc_destroy(ringbuffer_spsc_t *rb);
+int ringbuffer_spsc_mlock(ringbuffer_spsc_t *rb);
+size_t ringbuffer_spsc_size(const ringbuffer_spsc_t *rb);
+void ringbuffer_spsc_reset(ringbuffer_spsc_t *rb);
+int ringbuffer_spsc_reset_size(ringbuffer_spsc_t *rb, size_t sz);
+size_t ringbuffer_spsc_read_space(ringbuffer_spsc_t *rb);
+size_t ringbuffer_spsc_write_space(ringbuffer_spsc_t *rb);
+size_t ringbuffer_spsc_get(ringbuffer_spsc_t *rb, char *dest, size_t cnt);
+size_t ringbuffer_spsc_peek(ringbuffer_spsc_t *rb, char *dest, size_t cnt);
+size_t ringbuffer_spsc_put(ringbuffer_spsc_t *rb, const char *src, size_t cnt);
+void ringbuffer_spsc_read_advance(ringbuffer_spsc_t *rb, size_t cnt);
+void ringbuffer_spsc_write_advance(ringbuffer_spsc_t *rb, size_t cnt);
+void ringbuffer_spsc_get_read_vector(ringbuffer_spsc_t *rb,
+                                     ringbuffer_data_t *vec);
+void ringbuffer_spsc_get_write_vector(ringbuffer_spsc_t *rb,
+                                      ringbuffer_data_t *vec);
+
+/*
+ * Single-writer, multi-reader broadcast ring: every reader sees every
+ * byte through its own cursor, without per-reader copies of the data.
+ */
+typedef enum {
+    RINGBUFFER_BCAST_BLOCK = 0,   /* writer space is bounded by the slowest reader */
+    RINGBUFFER_BCAST_OVERRUN = 1  /* writer never waits; lapped readers skip ahead, see ringbuffer_bcast_overrun */
+}
+ringbuffer_bcast_policy_t ;
+
+typedef struct ringbuffer_bcast ringbuffer_bcast_t;
+
+ringbuffer_bcast_t *ringbuffer_bcast_create(size_t sz, int max_readers,
+                                            ringbuffer_bcast_policy_t policy);
+void ringbuffer_bcast_destroy(ringbuffer_bcast_t *rb);
+size_t ringbuffer_bcast_size(const ringbuffer_bcast_t *rb);
+int ringbuffer_bcast_add_reader(ringbuffer_bcast_t *rb);
+void ringbuffer_bcast_remove_reader(ringbuffer_bcast_t *rb, int reader);
+/* writer thread */
+size_t ringbuffer_bcast_write_space(ringbuffer_bcast_t *rb);
+size_t ringbuffer_bcast_put(ringbuffer_bcast_t *rb, const char *src, size_t cnt);
+size_t ringbuffer_bcast_get_write_vector(ringbuffer_bcast_t *rb, size_t max,
+                                         ringbuffer_data_t *vec);
+void ringbuffer_bcast_write_advance(ringbuffer_bcast_t *rb, size_t cnt);
+/* reader threads, one per reader id */
+size_t ringbuffer_bcast_read_space(ringbuffer_bcast_t *rb, int reader);
+size_t ringbuffer_bcast_get(ringbuffer_bcast_t *rb, int reader, char *dest, size_t cnt);
+void ringbuffer_bcast_get_read_vector(ringbuffer_bcast_t *rb, int reader,
+                                      ringbuffer_data_t *vec);
+int ringbuffer_bcast_read_advance(ringbuffer_bcast_t *rb, int reader, size_t cnt);
+size_t ringbuffer_bcast_overrun(ringbuffer_bcast_t *rb, int reader);
 
 #if defined (__cplusplus)
 }
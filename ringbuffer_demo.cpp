@@ -6,10 +6,18 @@
 // g++ -O2 -o test_case test_case.cc -ljack -lpthread
 
 #include "ringbuffer.h"
+#include <chrono>
 #include <memory>
 #include <thread>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 ringbuffer_t *ring_buffer;
 size_t capacity = 1024;
@@ -69,8 +77,104 @@ void thread2()
   }
 }
 
-int main()
+// ---------------------------------------------------------------------------
+// Throughput benchmark: ringbuffer_t vs ringbuffer_spsc_t
+// usage: ringbuffer_demo bench [megabytes]
+// ---------------------------------------------------------------------------
+
+static void pin_to_cpu(std::thread &t, unsigned cpu)
+{
+  unsigned n = std::thread::hardware_concurrency();
+  if (n < 2)
+    return; // nothing to separate
+#if defined(_WIN32)
+  SetThreadAffinityMask(t.native_handle(), DWORD_PTR(1) << (cpu % n));
+#elif defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu % n, &set);
+  pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+  (void)t;
+  (void)cpu;
+#endif
+}
+
+struct LegacyRing
+{
+  ringbuffer_t *rb;
+  explicit LegacyRing(size_t sz) : rb(ringbuffer_create(sz)) {}
+  ~LegacyRing() { ringbuffer_destroy(rb); }
+  size_t put(const char *p, size_t n) { return ringbuffer_put(rb, p, n); }
+  size_t get(char *p, size_t n) { return ringbuffer_get(rb, p, n); }
+};
+
+struct SpscRing
 {
+  ringbuffer_spsc_t *rb;
+  explicit SpscRing(size_t sz) : rb(ringbuffer_spsc_create(sz)) {}
+  ~SpscRing() { ringbuffer_spsc_destroy(rb); }
+  size_t put(const char *p, size_t n) { return ringbuffer_spsc_put(rb, p, n); }
+  size_t get(char *p, size_t n) { return ringbuffer_spsc_get(rb, p, n); }
+};
+
+// returns MB/s for moving `total` bytes in `chunk` sized put/get calls
+template <typename Ring>
+static double bench_ring(size_t capacity, size_t chunk, size_t total)
+{
+  Ring ring(capacity);
+  std::unique_ptr<char[]> src(new char[chunk]);
+  std::unique_ptr<char[]> dst(new char[chunk]);
+  memset(src.get(), 0x5a, chunk);
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread producer([&]() {
+    for (size_t sent = 0; sent < total;)
+    {
+      size_t n = ring.put(src.get(), chunk < total - sent ? chunk : total - sent);
+      if (n == 0)
+        std::this_thread::yield();
+      sent += n;
+    }
+  });
+  std::thread consumer([&]() {
+    for (size_t received = 0; received < total;)
+    {
+      size_t n = ring.get(dst.get(), chunk);
+      if (n == 0)
+        std::this_thread::yield();
+      received += n;
+    }
+  });
+  pin_to_cpu(producer, 0);
+  pin_to_cpu(consumer, 1);
+  producer.join();
+  consumer.join();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return double(total) / (1024.0 * 1024.0) / elapsed.count();
+}
+
+static int run_bench(size_t megabytes)
+{
+  const size_t capacity = 64 * 1024;
+  const size_t total = megabytes * 1024 * 1024;
+  printf("ring capacity %zu bytes, %zu MB per run, %u hardware threads\n",
+         capacity, megabytes, std::thread::hardware_concurrency());
+  printf("%8s %16s %16s %8s\n", "chunk", "ringbuffer MB/s", "spsc MB/s", "speedup");
+  for (size_t chunk = 8; chunk <= 16384; chunk *= 4)
+  {
+    double legacy = bench_ring<LegacyRing>(capacity, chunk, total);
+    double spsc = bench_ring<SpscRing>(capacity, chunk, total);
+    printf("%8zu %16.1f %16.1f %7.2fx\n", chunk, legacy, spsc, spsc / legacy);
+  }
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    return run_bench(argc > 2 ? strtoul(argv[2], nullptr, 10) : 256);
+
   size_t ntimes = 1000000;
   for (size_t i = 0; i < ntimes; ++i)
   {
@@ -268,4 +268,349 @@ TEST(RingBufferConcurrencyTest, SPSC_Correctness) {
     consumer.join();
 
     ringbuffer_destroy(rb);
-}
\ No newline at end of file
+}
+// 12. 测试镜像映射的 ringbuffer：回绕的数据也总是一段连续内存
+TEST(RingBufferMirroredTest, ContiguousVectorsAcrossWrap) {
+    auto rb = ringbuffer_create_mirrored(1000);
+    ASSERT_NE(rb, nullptr);
+    // 大小仍然是 2 的幂（镜像模式下至少一页）
+    EXPECT_EQ(rb->size & rb->size_mask, 0u);
+    EXPECT_GE(rb->size, 1000u);
+    if (!rb->mirrored) {
+        ringbuffer_destroy(rb);
+        GTEST_SKIP() << "mirrored mapping not available, fell back to ringbuffer_create";
+    }
+
+    // 两个映射指向同一块物理内存
+    rb->buf[3] = 'x';
+    EXPECT_EQ(rb->buf[rb->size + 3], 'x');
+
+    // 把读写指针推到末尾附近，写入跨越边界的数据
+    const size_t pos = rb->size - 5;
+    rb->read_ptr = pos;
+    rb->write_ptr = pos;
+    std::vector<char> in(64);
+    std::iota(in.begin(), in.end(), 'A');
+    ASSERT_EQ(ringbuffer_put(rb, in.data(), in.size()), in.size());
+    EXPECT_EQ(rb->write_ptr, (pos + in.size()) & rb->size_mask);
+
+    ringbuffer_data_t vec[2];
+    ringbuffer_get_read_vector(rb, vec);
+    EXPECT_EQ(vec[0].len, in.size());
+    EXPECT_EQ(vec[1].len, 0u);
+    EXPECT_EQ(memcmp(vec[0].buf, in.data(), in.size()), 0);
+
+    ringbuffer_get_write_vector(rb, vec);
+    EXPECT_EQ(vec[0].len, rb->size - 1 - in.size());
+    EXPECT_EQ(vec[1].len, 0u);
+
+    std::vector<char> out(in.size());
+    EXPECT_EQ(ringbuffer_peek(rb, out.data(), out.size()), out.size());
+    EXPECT_EQ(out, in);
+    std::fill(out.begin(), out.end(), 0);
+    EXPECT_EQ(ringbuffer_get(rb, out.data(), out.size()), out.size());
+    EXPECT_EQ(out, in);
+    EXPECT_TRUE(ringbuffer_is_empty(rb));
+
+    // mlock 可能因 RLIMIT_MEMLOCK 失败，成功时必须记录状态以便 destroy 解锁
+    if (ringbuffer_mlock(rb) == 0) {
+        EXPECT_EQ(rb->mlocked, 1);
+    }
+    ringbuffer_destroy(rb);
+}
+
+// 13. 镜像 ringbuffer 的 SPSC 并发测试，记录跨越边界
+TEST(RingBufferMirroredTest, SPSC_Records) {
+    auto rb = ringbuffer_create_mirrored(4096);
+    ASSERT_NE(rb, nullptr);
+    const uint32_t total = 200000;
+    const size_t record = 12; // 不能整除缓冲区大小，记录会跨越边界
+
+    std::thread producer([&]() {
+        char buf[record];
+        for (uint32_t i = 0; i < total; ++i) {
+            memset(buf, static_cast<int>(i & 0xff), sizeof(buf));
+            memcpy(buf, &i, sizeof(i));
+            while (ringbuffer_write_space(rb) < record) {
+                std::this_thread::yield();
+            }
+            ringbuffer_put(rb, buf, record);
+        }
+    });
+
+    bool ok = true;
+    for (uint32_t i = 0; i < total; ++i) {
+        while (ringbuffer_read_space(rb) < record) {
+            std::this_thread::yield();
+        }
+        // 镜像模式下直接在环形内存上解析整条记录
+        ringbuffer_data_t vec[2];
+        ringbuffer_get_read_vector(rb, vec);
+        if (rb->mirrored) {
+            ok = ok && vec[1].len == 0 && vec[0].len >= record;
+        }
+        char buf[record];
+        ringbuffer_get(rb, buf, record);
+        uint32_t value;
+        memcpy(&value, buf, sizeof(value));
+        ok = ok && value == i && static_cast<unsigned char>(buf[record - 1]) == (i & 0xff);
+    }
+    producer.join();
+    EXPECT_TRUE(ok);
+    ringbuffer_destroy(rb);
+}
+
+// 14. ringbuffer_spsc_t：整个缓冲区都可用，回绕后数据正确
+TEST(RingBufferSpscTest, PutGetWrapAround) {
+    auto rb = ringbuffer_spsc_create(1000);
+    ASSERT_NE(rb, nullptr);
+    EXPECT_EQ(ringbuffer_spsc_size(rb), 1024u);
+    EXPECT_EQ(ringbuffer_spsc_write_space(rb), 1024u);
+
+    std::vector<char> in(1024);
+    std::iota(in.begin(), in.end(), 0);
+    EXPECT_EQ(ringbuffer_spsc_put(rb, in.data(), in.size()), 1024u);
+    EXPECT_EQ(ringbuffer_spsc_put(rb, in.data(), 1), 0u); // 已满
+    EXPECT_EQ(ringbuffer_spsc_read_space(rb), 1024u);
+
+    std::vector<char> out(1024);
+    EXPECT_EQ(ringbuffer_spsc_get(rb, out.data(), 1000), 1000u);
+    EXPECT_EQ(ringbuffer_spsc_put(rb, in.data(), 100), 100u); // 跨越末尾
+
+    ringbuffer_data_t vec[2];
+    ringbuffer_spsc_get_read_vector(rb, vec);
+    EXPECT_EQ(vec[0].len, 24u);
+    EXPECT_EQ(vec[1].len, 100u);
+
+    EXPECT_EQ(ringbuffer_spsc_peek(rb, out.data() + 1000, 24), 24u);
+    EXPECT_EQ(ringbuffer_spsc_get(rb, out.data() + 1000, 24), 24u);
+    EXPECT_EQ(out, in);
+
+    std::vector<char> tail(200);
+    EXPECT_EQ(ringbuffer_spsc_get(rb, tail.data(), tail.size()), 100u);
+    EXPECT_TRUE(std::equal(tail.begin(), tail.begin() + 100, in.begin()));
+    EXPECT_EQ(ringbuffer_spsc_read_space(rb), 0u);
+    ringbuffer_spsc_destroy(rb);
+}
+
+// 15. reset_size 只接受不超过分配大小的 2 的幂
+TEST(RingBufferSpscTest, ResetSizeRejectsNonPowerOfTwo) {
+    auto rb = ringbuffer_spsc_create(1024);
+    ASSERT_NE(rb, nullptr);
+    EXPECT_EQ(ringbuffer_spsc_reset_size(rb, 1000), -1);
+    EXPECT_EQ(ringbuffer_spsc_reset_size(rb, 0), -1);
+    EXPECT_EQ(ringbuffer_spsc_reset_size(rb, 2048), -1);
+    EXPECT_EQ(ringbuffer_spsc_size(rb), 1024u);
+
+    EXPECT_EQ(ringbuffer_spsc_reset_size(rb, 256), 0);
+    EXPECT_EQ(ringbuffer_spsc_size(rb), 256u);
+    EXPECT_EQ(ringbuffer_spsc_write_space(rb), 256u);
+
+    // 零拷贝写入后 advance
+    ringbuffer_data_t vec[2];
+    ringbuffer_spsc_get_write_vector(rb, vec);
+    EXPECT_EQ(vec[0].len, 256u);
+    EXPECT_EQ(vec[1].len, 0u);
+    memcpy(vec[0].buf, "abc", 3);
+    ringbuffer_spsc_write_advance(rb, 3);
+    char out[3];
+    EXPECT_EQ(ringbuffer_spsc_get(rb, out, 3), 3u);
+    EXPECT_EQ(memcmp(out, "abc", 3), 0);
+    ringbuffer_spsc_destroy(rb);
+}
+
+// 16. ringbuffer_spsc_t 的 SPSC 并发测试
+TEST(RingBufferSpscTest, SPSC_Correctness) {
+    auto rb = ringbuffer_spsc_create(4096);
+    ASSERT_NE(rb, nullptr);
+    const uint32_t total_items = 1000000;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < total_items; ++i) {
+            while (ringbuffer_spsc_put(rb, (const char*)&i, sizeof(i)) == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // 出错后仍然读完全部数据，否则生产者会在满的环上一直空转
+    bool ok = true;
+    for (uint32_t i = 0; i < total_items; ++i) {
+        // 4096 是 4 的倍数，单个值不会被拆开
+        uint32_t value;
+        while (ringbuffer_spsc_get(rb, (char*)&value, sizeof(value)) == 0) {
+            std::this_thread::yield();
+        }
+        ok = ok && value == i;
+    }
+    producer.join();
+    EXPECT_TRUE(ok);
+    ringbuffer_spsc_destroy(rb);
+}
+
+// 17. 广播 ringbuffer：BLOCK 模式下写端空间受最慢的读者限制，每个读者都能读到全部数据
+TEST(RingBufferBroadcastTest, BlockBoundedBySlowestReader) {
+    auto rb = ringbuffer_bcast_create(256, 3, RINGBUFFER_BCAST_BLOCK);
+    ASSERT_NE(rb, nullptr);
+    int a = ringbuffer_bcast_add_reader(rb);
+    int b = ringbuffer_bcast_add_reader(rb);
+    ASSERT_GE(a, 0);
+    ASSERT_GE(b, 0);
+
+    std::vector<char> in(256);
+    std::iota(in.begin(), in.end(), 0);
+    EXPECT_EQ(ringbuffer_bcast_put(rb, in.data(), in.size()), 256u);
+    EXPECT_EQ(ringbuffer_bcast_write_space(rb), 0u);
+
+    std::vector<char> out(256);
+    EXPECT_EQ(ringbuffer_bcast_get(rb, a, out.data(), out.size()), 256u);
+    EXPECT_EQ(out, in);
+    // b 还没有读，写端仍然没有空间
+    EXPECT_EQ(ringbuffer_bcast_write_space(rb), 0u);
+
+    // b 用零拷贝接口读一半
+    ringbuffer_data_t vec[2];
+    ringbuffer_bcast_get_read_vector(rb, b, vec);
+    EXPECT_EQ(vec[0].len + vec[1].len, 256u);
+    EXPECT_EQ(memcmp(vec[0].buf, in.data(), vec[0].len), 0);
+    EXPECT_EQ(ringbuffer_bcast_read_advance(rb, b, 128), 0);
+    EXPECT_EQ(ringbuffer_bcast_write_space(rb), 128u);
+
+    // 移除慢读者后写端不再等待它
+    ringbuffer_bcast_remove_reader(rb, b);
+    EXPECT_EQ(ringbuffer_bcast_write_space(rb), 256u);
+    EXPECT_EQ(ringbuffer_bcast_overrun(rb, a), 0u);
+    ringbuffer_bcast_destroy(rb);
+}
+
+// 18. OVERRUN 模式：写端从不等待，被套圈的读者跳到最新位置并报告丢失的字节数
+TEST(RingBufferBroadcastTest, OverrunSkipsAndFlagsSlowReader) {
+    auto rb = ringbuffer_bcast_create(64, 2, RINGBUFFER_BCAST_OVERRUN);
+    ASSERT_NE(rb, nullptr);
+    int fast = ringbuffer_bcast_add_reader(rb);
+    int slow = ringbuffer_bcast_add_reader(rb);
+    EXPECT_EQ(ringbuffer_bcast_add_reader(rb), -1); // 读者槽位已满
+
+    char chunk[32];
+    char out[64];
+    for (int i = 0; i < 4; ++i) {
+        memset(chunk, 'a' + i, sizeof(chunk));
+        EXPECT_EQ(ringbuffer_bcast_put(rb, chunk, sizeof(chunk)), sizeof(chunk));
+        EXPECT_EQ(ringbuffer_bcast_get(rb, fast, out, sizeof(out)), sizeof(chunk));
+        EXPECT_EQ(out[0], 'a' + i);
+    }
+    EXPECT_EQ(ringbuffer_bcast_overrun(rb, fast), 0u);
+
+    // slow 落后 128 字节，超过了 64 字节的缓冲区
+    EXPECT_EQ(ringbuffer_bcast_read_space(rb, slow), 0u);
+    EXPECT_EQ(ringbuffer_bcast_overrun(rb, slow), 128u);
+    EXPECT_EQ(ringbuffer_bcast_overrun(rb, slow), 0u);
+
+    memset(chunk, 'z', sizeof(chunk));
+    ringbuffer_bcast_put(rb, chunk, sizeof(chunk));
+    EXPECT_EQ(ringbuffer_bcast_get(rb, slow, out, sizeof(out)), sizeof(chunk));
+    EXPECT_EQ(out[0], 'z');
+    ringbuffer_bcast_destroy(rb);
+}
+
+// 19. 一个写者、三个读者并发，BLOCK 模式下每个读者收到完整有序的数据
+TEST(RingBufferBroadcastTest, ConcurrentReaders) {
+    auto rb = ringbuffer_bcast_create(1024, 3, RINGBUFFER_BCAST_BLOCK);
+    ASSERT_NE(rb, nullptr);
+    const uint32_t total = 200000;
+    int ids[3];
+    for (int& id : ids) {
+        id = ringbuffer_bcast_add_reader(rb);
+        ASSERT_GE(id, 0);
+    }
+
+    std::atomic<int> errors(0);
+    std::vector<std::thread> readers;
+    for (int id : ids) {
+        readers.emplace_back([&, id]() {
+            for (uint32_t i = 0; i < total; ++i) {
+                uint32_t value;
+                while (ringbuffer_bcast_get(rb, id, (char*)&value, sizeof(value)) == 0) {
+                    std::this_thread::yield();
+                }
+                if (value != i) {
+                    errors++;
+                    return;
+                }
+            }
+        });
+    }
+    for (uint32_t i = 0; i < total; ++i) {
+        while (ringbuffer_bcast_put(rb, (const char*)&i, sizeof(i)) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(errors.load(), 0);
+    ringbuffer_bcast_destroy(rb);
+}
+
+// 20. ringbuffer_wait_read：读者睡眠等待，写者写入足够数据后被唤醒；超时返回当前可读字节数
+TEST(RingBufferWaitTest, WaitReadWakesAndTimesOut) {
+    auto rb = ringbuffer_create(1024);
+    ASSERT_NE(rb, nullptr);
+    // 未启用时不阻塞
+    EXPECT_EQ(ringbuffer_wait_read(rb, 1, 1000), 0u);
+    ASSERT_EQ(ringbuffer_enable_wait(rb), 0);
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(ringbuffer_wait_read(rb, 1, 20), 0u);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    std::thread producer([&]() {
+        for (int i = 0; i < 4; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            ringbuffer_put(rb, "abcd", 4);
+        }
+    });
+    // 需要 16 字节，前几次唤醒不满足条件时继续等待
+    EXPECT_EQ(ringbuffer_wait_read(rb, 16, 10000), 16u);
+    producer.join();
+
+    char out[16];
+    EXPECT_EQ(ringbuffer_get(rb, out, sizeof(out)), 16u);
+    EXPECT_EQ(memcmp(out, "abcdabcdabcdabcd", 16), 0);
+    ringbuffer_destroy(rb);
+}
+
+// 21. 使用 ringbuffer_wait_read 代替轮询的 SPSC 测试
+TEST(RingBufferWaitTest, SPSC_BlockingReader) {
+    auto rb = ringbuffer_create(256);
+    ASSERT_NE(rb, nullptr);
+    ASSERT_EQ(ringbuffer_enable_wait(rb), 0);
+    const uint32_t total = 100000;
+
+    std::atomic<bool> stop{ false };
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < total; ++i) {
+            while (ringbuffer_write_space(rb) < sizeof(i)) {
+                if (stop.load()) return;
+                std::this_thread::yield();
+            }
+            ringbuffer_put(rb, (const char*)&i, sizeof(i));
+        }
+    });
+
+    // 数据出错时继续读完，超时则让生产者退出，总之先 join 再报告失败，测试不会挂住
+    bool ok = true;
+    for (uint32_t i = 0; i < total; ++i) {
+        if (ringbuffer_wait_read(rb, sizeof(uint32_t), 10000) < sizeof(uint32_t)) {
+            ok = false;
+            stop = true;
+            break;
+        }
+        uint32_t value;
+        ringbuffer_get(rb, (char*)&value, sizeof(value));
+        ok = ok && value == i;
+    }
+    producer.join();
+    EXPECT_TRUE(ok);
+    ringbuffer_destroy(rb);
+}